@@ -6,10 +6,6 @@ namespace allocator
     constexpr std::size_t BITS_IN_BYTE = 8;
 
 
-    constexpr std::size_t SIZE_T_SIZE_IN_BITS =
-        BITS_IN_BYTE * sizeof(std::size_t);
-
-
     std::size_t size_in_bytes(std::size_t size_in_bits)
     {
         return blocks_fitting(size_in_bits, BITS_IN_BYTE);
@@ -38,42 +34,6 @@ namespace allocator
     }
 
 
-    std::size_t next_power_of_two(std::size_t x)
-    {
-        assert(x > 0);
-        --x;
-
-        for (auto i = std::size_t(1);
-             i < SIZE_T_SIZE_IN_BITS;
-             i <<= 1)
-        {
-            x |= x >> i;
-        }
-
-        return x + 1;
-    }
-
-
-    std::size_t log2(std::size_t x)
-    {
-        assert(x > 0);
-        auto result = std::size_t(0);
-
-        for (auto i = std::size_t(SIZE_T_SIZE_IN_BITS / 2);
-             i > 0;
-             i >>= 1)
-        {
-            if (x >= (std::size_t(1) << i))
-            {
-                result += i;
-                x >>= i;
-            }
-        }
-
-        return result;
-    }
-
-
     std::size_t to_level_index(std::size_t index, std::size_t level)
     {
         return index - first_index_at(level);
@@ -2,6 +2,7 @@
 #define __ARITHMETIC_HEADER_INCLUDED__
 
 #include <assert.h>
+#include <climits>
 #include <cstddef>
 
 
@@ -14,6 +15,9 @@ namespace allocator
     };
 
 
+    constexpr std::size_t SIZE_T_SIZE_IN_BITS = CHAR_BIT * sizeof(std::size_t);
+
+
     std::size_t size_in_bytes(std::size_t size_in_bits);
 
 
@@ -27,19 +31,75 @@ namespace allocator
     DivisionResult divided_by_bits_in_byte(std::size_t bits_count);
 
 
-    std::size_t next_power_of_two(std::size_t x);
+    constexpr std::size_t count_leading_zeros(std::size_t x)
+    {
+        assert(x > 0);
+#if defined(__GNUC__)
+        return __builtin_clzll(x) -
+               (CHAR_BIT * sizeof(unsigned long long) - SIZE_T_SIZE_IN_BITS);
+#else
+        auto result = std::size_t(0);
+
+        for (auto i = std::size_t(SIZE_T_SIZE_IN_BITS / 2);
+             i > 0;
+             i >>= 1)
+        {
+            if (x < (std::size_t(1) << (SIZE_T_SIZE_IN_BITS - i)))
+            {
+                result += i;
+                x <<= i;
+            }
+        }
+
+        return result;
+#endif
+    }
+
+
+    constexpr std::size_t count_trailing_zeros(std::size_t x)
+    {
+        assert(x > 0);
+#if defined(__GNUC__)
+        return __builtin_ctzll(x);
+#else
+        auto result = std::size_t(0);
+
+        for (; (x & 1) == 0; x >>= 1)
+        {
+            ++result;
+        }
+
+        return result;
+#endif
+    }
+
+
+    constexpr std::size_t log2(std::size_t x)
+    {
+        return SIZE_T_SIZE_IN_BITS - 1 - count_leading_zeros(x);
+    }
 
 
-    std::size_t log2(std::size_t x);
+    constexpr std::size_t next_power_of_two(std::size_t x)
+    {
+        assert(x > 0);
+        return x == 1 ? 1 : std::size_t(1) << (log2(x - 1) + 1);
+    }
 
 
     std::size_t to_level_index(std::size_t index,
                                std::size_t level);
 
 
-    inline std::size_t two_to_the_power_of(std::size_t n)
+    constexpr std::size_t two_to_the_power_of(std::size_t n)
+    {
+        return std::size_t(1) << n;
+    }
+
+
+    constexpr bool is_power_of_two(std::size_t x)
     {
-        return 1 << n;
+        return x != 0 && (x & (x - 1)) == 0;
     }
 
 
@@ -1,29 +1,133 @@
 #include "bitmap.hpp"
 
+#include <assert.h>
 #include <utility>
 
 #include "arithmetic.hpp"
 
+#if UINTPTR_MAX == UINT64_MAX && defined(__AVX2__)
+#define __BITMAP_SCAN_WITH_AVX2__
+#include <immintrin.h>
+#elif UINTPTR_MAX == UINT64_MAX && defined(__SSE4_1__)
+#define __BITMAP_SCAN_WITH_SSE4_1__
+#include <smmintrin.h>
+#endif
+
 
 namespace allocator
 {
+    namespace
+    {
+        using Word = BitMap::Word;
+
+
+        std::size_t count_set_bits(Word word)
+        {
+#if defined(__GNUC__)
+            return __builtin_popcountll(word);
+#else
+            auto count = std::size_t(0);
+
+            for (; word != 0; word &= word - 1)
+            {
+                ++count;
+            }
+
+            return count;
+#endif
+        }
+
+
+        std::size_t first_word_other_than(Word value,
+                                          const Word* words,
+                                          std::size_t begin,
+                                          std::size_t end)
+        {
+            // Long runs of equal words (fully split or fully free regions)
+            // are skipped several words at a time when the target has SIMD
+            // compare instructions.
+#if defined(__BITMAP_SCAN_WITH_AVX2__)
+            const auto pattern =
+                _mm256_set1_epi64x(static_cast<long long>(value));
+
+            for (; begin + 4 <= end; begin += 4)
+            {
+                const auto chunk = _mm256_loadu_si256(
+                    reinterpret_cast<const __m256i*>(words + begin)
+                );
+
+                if (_mm256_movemask_epi8(
+                        _mm256_cmpeq_epi64(chunk, pattern)) != -1)
+                {
+                    break;
+                }
+            }
+#elif defined(__BITMAP_SCAN_WITH_SSE4_1__)
+            const auto pattern =
+                _mm_set1_epi64x(static_cast<long long>(value));
+
+            for (; begin + 2 <= end; begin += 2)
+            {
+                const auto chunk = _mm_loadu_si128(
+                    reinterpret_cast<const __m128i*>(words + begin)
+                );
+
+                if (_mm_movemask_epi8(
+                        _mm_cmpeq_epi64(chunk, pattern)) != 0xFFFF)
+                {
+                    break;
+                }
+            }
+#endif
+            while (begin < end && words[begin] == value)
+            {
+                ++begin;
+            }
+
+            return begin;
+        }
+
+    }
+
+
     BitMap::BitMap(unsigned char* bits,
                    std::size_t size,
                    bool initial_value) :
-        bits(bits),
+        words(reinterpret_cast<Word*>(bits)),
         size(size)
     {
         assert(size == 0 || bits != nullptr);
-        const auto end = size_in_bytes(size);
-        const auto value = initial_byte_value_for(initial_value);
+        assert(reinterpret_cast<std::uintptr_t>(bits) % alignof(Word) == 0);
+        const auto end = words_for(size);
+        const auto value = initial_word_value_for(initial_value);
 
         for (auto i = std::size_t(0); i < end; ++i)
         {
-            bits[i] = value;
+            words[i] = value;
         }
     }
 
 
+    BitMap BitMap::over_zero_filled(unsigned char* bits, std::size_t size)
+    {
+        // The storage already holds the words of a cleared map, so it is
+        // not written and pages behind it stay untouched until needed.
+        return over_existing(bits, size);
+    }
+
+
+    BitMap BitMap::over_existing(unsigned char* bits, std::size_t size)
+    {
+        assert(size == 0 || bits != nullptr);
+        assert(reinterpret_cast<std::uintptr_t>(bits) % alignof(Word) == 0);
+        auto result = BitMap{};
+        result.words = reinterpret_cast<Word*>(bits);
+        result.size = size;
+
+        return result;
+    }
+
+
     BitMap::BitMap(BitMap&& source) :
         BitMap{}
     {
@@ -33,7 +137,7 @@ namespace allocator
 
     void BitMap::swap_contents_with(BitMap& map)
     {
-        std::swap(this->bits, map.bits);
+        std::swap(this->words, map.words);
         std::swap(this->size, map.size);
     }
 
@@ -52,30 +156,153 @@ namespace allocator
 
     bool BitMap::at(std::size_t index) const
     {
-        const auto pair = byte_for_bit_at(index);
+        const auto pair = word_for_bit_at(index);
 
-        return pair.byte & pair.mask;
+        return (pair.word & pair.mask) != 0;
     }
 
 
-    BitMap::Bytes
-    BitMap::byte_for_bit_at(std::size_t index) const
+    BitMap::WordAndMask
+    BitMap::word_for_bit_at(std::size_t index) const
     {
         assert(index < this->size);
-        const auto pair = divided_by_bits_in_byte(index);
 
-        return { bits[pair.quotient],
-                 static_cast<unsigned char>(
-                     0b10000000 >> pair.remainder
-                 ) };
+        return { words[index / WORD_SIZE_IN_BITS],
+                 Word(1) << (index % WORD_SIZE_IN_BITS) };
     }
 
 
     void BitMap::flip(std::size_t index)
     {
-        auto pair = byte_for_bit_at(index);
+        auto pair = word_for_bit_at(index);
+
+        pair.word ^= pair.mask;
+    }
+
+
+    void BitMap::set_range(std::size_t begin, std::size_t end)
+    {
+        apply_to_range(begin, end, [](Word& word, Word mask)
+        {
+            word |= mask;
+        });
+    }
+
+
+    void BitMap::clear_range(std::size_t begin, std::size_t end)
+    {
+        apply_to_range(begin, end, [](Word& word, Word mask)
+        {
+            word &= ~mask;
+        });
+    }
+
+
+    void BitMap::flip_range(std::size_t begin, std::size_t end)
+    {
+        apply_to_range(begin, end, [](Word& word, Word mask)
+        {
+            word ^= mask;
+        });
+    }
+
+
+    template <class Operation>
+    void BitMap::apply_to_range(std::size_t begin,
+                                std::size_t end,
+                                Operation operation)
+    {
+        assert(begin <= end);
+        assert(end <= this->size);
+
+        if (begin == end)
+        {
+            return;
+        }
+
+        const auto first = begin / WORD_SIZE_IN_BITS;
+        const auto last = (end - 1) / WORD_SIZE_IN_BITS;
+        const auto first_mask = mask_from(begin);
+        const auto last_mask = mask_through(end - 1);
+
+        if (first == last)
+        {
+            operation(words[first], first_mask & last_mask);
+        }
+        else
+        {
+            operation(words[first], first_mask);
+
+            for (auto i = first + 1; i < last; ++i)
+            {
+                operation(words[i], ~Word(0));
+            }
+
+            operation(words[last], last_mask);
+        }
+    }
+
+
+    std::size_t BitMap::find_first_set(std::size_t from) const
+    {
+        return find_first_not(0, from);
+    }
+
+
+    std::size_t BitMap::find_first_clear(std::size_t from) const
+    {
+        return find_first_not(~Word(0), from);
+    }
+
+
+    std::size_t BitMap::find_first_not(Word skipped, std::size_t from) const
+    {
+        if (from >= this->size)
+        {
+            return this->size;
+        }
+
+        auto i = from / WORD_SIZE_IN_BITS;
+        auto differing_bits = (words[i] ^ skipped) & mask_from(from);
+
+        if (differing_bits == 0)
+        {
+            const auto words_count = words_for(this->size);
+            i = first_word_other_than(skipped, words, i + 1, words_count);
+
+            if (i == words_count)
+            {
+                return this->size;
+            }
+
+            differing_bits = words[i] ^ skipped;
+        }
+
+        // Bits past the end of the map are not initialised, so a match
+        // there means there is no match at all.
+        const auto index =
+            i * WORD_SIZE_IN_BITS + count_trailing_zeros(differing_bits);
+
+        return index < this->size ? index : this->size;
+    }
+
+
+    std::size_t BitMap::count() const
+    {
+        if (is_empty())
+        {
+            return 0;
+        }
+
+        const auto last = (this->size - 1) / WORD_SIZE_IN_BITS;
+        auto result = count_set_bits(words[last] & mask_through(size - 1));
+
+        for (auto i = std::size_t(0); i < last; ++i)
+        {
+            result += count_set_bits(words[i]);
+        }
 
-        pair.byte ^= pair.mask;
+        return result;
     }
 
 }
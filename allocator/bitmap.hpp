@@ -1,22 +1,31 @@
 #ifndef __BITMAP_HEADER_INCLUDED__
 #define __BITMAP_HEADER_INCLUDED__
 
+#include <climits>
 #include <cstddef>
+#include <cstdint>
 
 
 namespace allocator
 {
     class BitMap
     {
-        struct Bytes
+    public:
+        using Word = std::uintptr_t;
+
+    private:
+        struct WordAndMask
         {
-            unsigned char& byte;
-            unsigned char mask;
+            Word& word;
+            Word mask;
         };
 
+    public:
+        static const std::size_t WORD_SIZE_IN_BITS = CHAR_BIT * sizeof(Word);
+
     public:
         BitMap() :
-            bits(nullptr),
+            words(nullptr),
             size(0)
         {
         }
@@ -27,8 +36,17 @@ namespace allocator
         BitMap(BitMap&& source);
         BitMap& operator=(BitMap&& rhs);
 
+        static BitMap over_zero_filled(unsigned char* bits, std::size_t size);
+        static BitMap over_existing(unsigned char* bits, std::size_t size);
+
         bool at(std::size_t index) const;
         void flip(std::size_t index);
+        void set_range(std::size_t begin, std::size_t end);
+        void clear_range(std::size_t begin, std::size_t end);
+        void flip_range(std::size_t begin, std::size_t end);
+        std::size_t find_first_set(std::size_t from = 0) const;
+        std::size_t find_first_clear(std::size_t from = 0) const;
+        std::size_t count() const;
 
         bool is_empty() const
         {
@@ -40,22 +58,47 @@ namespace allocator
             return size;
         }
 
+        static constexpr std::size_t storage_size_for(std::size_t size)
+        {
+            return words_for(size) * sizeof(Word);
+        }
+
     private:
-        static unsigned char
-        initial_byte_value_for(bool initial_flag_value)
+        static Word initial_word_value_for(bool initial_flag_value)
+        {
+            return initial_flag_value ? ~Word(0) : 0;
+        }
+
+        static constexpr std::size_t words_for(std::size_t size)
+        {
+            return size / WORD_SIZE_IN_BITS +
+                   (size % WORD_SIZE_IN_BITS != 0 ? 1 : 0);
+        }
+
+        static Word mask_from(std::size_t bit)
+        {
+            return ~Word(0) << (bit % WORD_SIZE_IN_BITS);
+        }
+
+        static Word mask_through(std::size_t bit)
         {
-            return initial_flag_value ? 0b11111111 : 0;
+            return ~Word(0) >> (WORD_SIZE_IN_BITS - 1 - bit % WORD_SIZE_IN_BITS);
         }
 
     private:
-        Bytes byte_for_bit_at(std::size_t index) const;
+        WordAndMask word_for_bit_at(std::size_t index) const;
+        template <class Operation>
+        void apply_to_range(std::size_t begin,
+                            std::size_t end,
+                            Operation operation);
+        std::size_t find_first_not(Word skipped, std::size_t from) const;
         void swap_contents_with(BitMap& map);
 
     private:
-        unsigned char* bits;
+        Word* words;
         std::size_t size;
     };
 
 }
 
-#endif // __BITMAP_HEADER_INCLUDED__
\ No newline at end of file
+#endif // __BITMAP_HEADER_INCLUDED__
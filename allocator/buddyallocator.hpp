@@ -1,20 +1,80 @@
 #ifndef __BUDDY_ALLOCATOR_HEADER_INCLUDED__
 #define __BUDDY_ALLOCATOR_HEADER_INCLUDED__
 
+#include <algorithm>
+#include <assert.h>
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <utility>
 
 #include "arithmetic.hpp"
 #include "bitmap.hpp"
+#include "buddystats.hpp"
 #include "freelist.hpp"
+#include "insufficientmemory.hpp"
+#include "levellocks.hpp"
+#include "virtualmemory.hpp"
 
 
 namespace allocator
 {
-    class BuddyAllocator
+    enum class LevelLookup
+    {
+        split_map,
+        level_map
+    };
+
+
+    enum class MemoryContents
+    {
+        unknown,
+        zero_filled
+    };
+
+
+    // Holds an allocator's statistics as a base class, so that empty ones
+    // such as NoStats take no space in it. Inheriting from the statistics
+    // themselves would bring their members into the allocator's scope.
+    template <class Stats>
+    class StatsStorage : private Stats
+    {
+    protected:
+        StatsStorage() = default;
+
+        explicit StatsStorage(Stats&& source) :
+            Stats(std::move(source))
+        {
+        }
+
+        Stats& stats()
+        {
+            return *this;
+        }
+
+        const Stats& stats() const
+        {
+            return *this;
+        }
+    };
+
+
+    template <std::size_t LeafSize,
+              std::size_t Alignment,
+              class Stats = NoStats>
+    class BasicBuddyAllocator : private StatsStorage<Stats>
     {
         using PtrValueType = intptr_t;
 
+        friend class ConcurrentBuddyAllocator;
+        friend class SharedBuddyAllocator;
+        friend class OwnedBuddyAllocator;
+        friend class SlabAllocator;
+
         struct MemoryDescriptor
         {
             void* start;
@@ -22,23 +82,93 @@ namespace allocator
             std::size_t wasted_bytes_at_end;
         };
 
+        struct Batch
+        {
+            std::size_t count;
+            std::size_t deepest_level;
+        };
+
     public:
-        BuddyAllocator();
-        BuddyAllocator(void* memory, std::size_t size);
-        BuddyAllocator(BuddyAllocator&& source);
-        BuddyAllocator& operator=(BuddyAllocator&& rhs);
+        BasicBuddyAllocator();
+        BasicBuddyAllocator(
+            void* memory,
+            std::size_t size,
+            LevelLookup lookup = LevelLookup::split_map,
+            MemoryContents contents = MemoryContents::unknown
+        );
+        BasicBuddyAllocator(
+            void* memory,
+            std::size_t size,
+            void* metadata,
+            std::size_t metadata_size,
+            LevelLookup lookup = LevelLookup::split_map,
+            MemoryContents metadata_contents = MemoryContents::unknown
+        );
+        BasicBuddyAllocator(BasicBuddyAllocator&& source);
+        BasicBuddyAllocator& operator=(BasicBuddyAllocator&& rhs);
 
         void* allocate(std::size_t size);
+        void* allocate(std::size_t size, std::size_t alignment);
         void deallocate(void* block);
         void deallocate(void* block, std::size_t size);
+        void deallocate(void* block,
+                        std::size_t size,
+                        std::size_t alignment);
+        void* reallocate(void* block,
+                         std::size_t old_size,
+                         std::size_t new_size);
+        bool try_expand_in_place(void* block,
+                                 std::size_t old_size,
+                                 std::size_t new_size);
+        void* allocate_exact(std::size_t size);
+        void deallocate_exact(void* block, std::size_t size);
+        std::size_t allocate_n(std::size_t size,
+                               std::size_t count,
+                               void** blocks);
+        void deallocate_n(void** blocks, std::size_t count);
+        void deallocate_n(void** blocks,
+                          std::size_t count,
+                          std::size_t size);
+        std::size_t trim(std::size_t min_block_size = 0);
 
         bool manages_memory() const
         {
             return free_lists != nullptr;
         }
 
+        void set_purge_threshold(std::size_t threshold)
+        {
+            purge_threshold = threshold;
+        }
+
+        std::size_t get_purge_threshold() const
+        {
+            return purge_threshold;
+        }
+
+        const Stats& get_stats() const
+        {
+            return this->stats();
+        }
+
+        static constexpr std::size_t required_metadata_size(
+            std::size_t size,
+            LevelLookup lookup = LevelLookup::split_map
+        )
+        {
+            // An upper bound, aligning the managed block can only make its
+            // tree smaller.
+            return size < 2 * LeafSize ?
+                   0 :
+                   (METADATA_ALIGNMENT - 1) +
+                   lists_storage_size(levels_count_for(size)) +
+                   2 * maps_storage_size(levels_count_for(size)) +
+                   (lookup == LevelLookup::level_map ? size / LeafSize : 0);
+        }
+
     private:
         static void verify_pointer_is_not_null(void* memory);
+        static void verify_alignment(std::size_t alignment);
         static void* first_aligned_address_within(void* memory,
                                                   std::size_t size);
         static std::size_t compute_size_per_list(
@@ -55,6 +185,24 @@ namespace allocator
             return reinterpret_cast<char*>(p) + offset;
         }
 
+        static void* metadata_lists_start(void* metadata)
+        {
+            // The lists, the maps and the level map follow each other in
+            // the metadata buffer, which required_metadata_size leaves
+            // room to align.
+            auto space = std::size_t(METADATA_ALIGNMENT);
+            const auto result =
+                std::align(METADATA_ALIGNMENT, 1, metadata, space);
+            assert(result != nullptr);
+
+            return result;
+        }
+
+        static void* subtract_from(void* p, std::size_t offset)
+        {
+            return reinterpret_cast<char*>(p) - offset;
+        }
+
         static PtrValueType value_of_pointer(void* p)
         {
             return reinterpret_cast<PtrValueType>(p);
@@ -70,6 +218,27 @@ namespace allocator
             return blocks_fitting(size_in_bytes, LEAF_SIZE);
         }
 
+        static std::size_t level_of_batch_entry(void* entry)
+        {
+            return reinterpret_cast<std::uintptr_t>(entry) &
+                   (two_to_the_power_of(BATCH_ENTRY_LEVEL_BITS) - 1);
+        }
+
+        static std::size_t leaves_before_batch_entry(void* entry)
+        {
+            return reinterpret_cast<std::uintptr_t>(entry) >>
+                   BATCH_ENTRY_LEVEL_BITS;
+        }
+
+        static void* to_batch_entry(std::size_t leaves_before_block,
+                                    std::size_t level)
+        {
+            return reinterpret_cast<void*>(
+                (std::uintptr_t(leaves_before_block) <<
+                 BATCH_ENTRY_LEVEL_BITS) | level
+            );
+        }
+
         static std::size_t free_map_index_for(std::size_t index)
         {
             index += index % 2;
@@ -77,6 +246,28 @@ namespace allocator
             return index / 2;
         }
 
+        static constexpr std::size_t levels_count_for(std::size_t size)
+        {
+            return log2(next_power_of_two(size) / LeafSize) + 1;
+        }
+
+        static constexpr std::size_t lists_storage_size(
+            std::size_t levels_count
+        )
+        {
+            return (levels_count * sizeof(FreeList) + METADATA_ALIGNMENT - 1) /
+                   METADATA_ALIGNMENT * METADATA_ALIGNMENT;
+        }
+
+        static constexpr std::size_t maps_storage_size(
+            std::size_t levels_count
+        )
+        {
+            return BitMap::storage_size_for(
+                two_to_the_power_of(levels_count - 1)
+            );
+        }
+
     private:
         MemoryDescriptor set_logical_start_size_and_levels_count(
             void* memory,
@@ -85,9 +276,28 @@ namespace allocator
         void set_size(std::size_t actual_size);
         void set_start(void* actual_start, std::size_t actual_size);
         void set_levels_count();
-        void* create_data_structures(MemoryDescriptor memory);
+        void* create_data_structures(const MemoryDescriptor& memory,
+                                     LevelLookup lookup,
+                                     MemoryContents contents);
         MemoryDescriptor create_free_lists(const MemoryDescriptor& memory);
-        void* create_maps(const MemoryDescriptor& memory);
+        void* create_maps(const MemoryDescriptor& memory,
+                          MemoryContents contents);
+        void create_maps_at(unsigned char* maps_start,
+                            MemoryContents contents);
+        void create_external_data_structures(void* metadata,
+                                             const MemoryDescriptor& memory,
+                                             LevelLookup lookup,
+                                             MemoryContents contents);
+        void attach(void* memory,
+                    std::size_t size,
+                    void* metadata,
+                    LevelLookup lookup);
+        unsigned char* maps_within(void* metadata);
+        void set_level_map_within(unsigned char* maps_start,
+                                  const MemoryDescriptor& memory,
+                                  LevelLookup lookup);
+        void* create_level_map(void* free_memory_start,
+                               const MemoryDescriptor& memory);
         void initialise_data_structures(void* free_memory_start);
         void preallocate_leaves_until(std::size_t leaf);
         void mark_blocks_as_allocated_until(std::size_t index,
@@ -99,16 +309,96 @@ namespace allocator
                                    std::size_t last_allocated_block,
                                    std::size_t last_allocated_parent);
         void* to_address(std::size_t index, std::size_t level) const;
-        void* allocate_block_at(std::size_t level);
+        void* allocate_block_at(std::size_t level, LevelLocks& locks);
+        void split(void* block,
+                   std::size_t level,
+                   std::size_t target_level,
+                   LevelLocks& locks);
+        void split_off_tail(void* block,
+                            std::size_t level,
+                            std::size_t size,
+                            LevelLocks& locks);
+        template <class Function>
+        void for_each_piece_of(void* block,
+                               std::size_t size,
+                               Function function) const;
+        std::size_t level_of_last_piece_of(std::size_t size) const;
+        bool grow(void* block, std::size_t level, std::size_t target_level);
+        void shrink(void* block, std::size_t level, std::size_t target_level);
         int level_for_block_with(std::size_t size) const;
         std::size_t index_at(std::size_t level, void* ptr) const;
         std::size_t index_of(void* ptr, std::size_t level) const;
-        void free(void* block, std::size_t level);
-        void free(void* block, std::size_t level, std::size_t index);
-        std::size_t level_of(void* p) const;
+        void free(void* block, std::size_t level, LevelLocks& locks);
+        void free(void* block,
+                  std::size_t level,
+                  std::size_t index,
+                  LevelLocks& locks);
+        std::size_t allocate_blocks_at(std::size_t level,
+                                       std::size_t count,
+                                       void** blocks,
+                                       LevelLocks& locks);
+        Batch to_batch_entries(void** blocks,
+                               std::size_t count,
+                               LevelLocks& locks) const;
+        std::size_t to_batch_entries(void** blocks,
+                                     std::size_t count,
+                                     std::size_t level) const;
+        void free_batch(void** entries,
+                        std::size_t count,
+                        LevelLocks& locks);
+        bool is_left_buddy_of(void* left, void* right) const;
+        void* merge_with_right_buddy(void* left, LevelLocks& locks);
+        std::size_t trim(std::size_t min_block_size, LevelLocks& locks);
+        std::size_t purge(void* block, std::size_t level);
+        std::size_t level_of(void* p, LevelLocks& locks) const;
+        std::size_t level_in_split_map_of(void* p, LevelLocks& locks) const;
+        void mark_levels_as_non_empty(std::size_t levels,
+                                      const LevelLocks& locks);
+        void mark_level_as_empty(std::size_t level, const LevelLocks& locks);
         void flip_free_map_at(std::size_t index);
         bool free_map_at(std::size_t index) const;
-        void swap_contents_with(BuddyAllocator& other);
+        void swap_contents_with(BasicBuddyAllocator& other);
+
+        void* to_batch_entry(void* block, std::size_t level) const
+        {
+            return to_batch_entry(
+                std::size_t(value_of_pointer(block) - start) / LEAF_SIZE,
+                level
+            );
+        }
+
+        void* block_of_batch_entry(void* entry) const
+        {
+            return as_pointer(
+                start + leaves_before_batch_entry(entry) * LEAF_SIZE
+            );
+        }
+
+        std::size_t leaves_in_block_at(std::size_t level) const
+        {
+            return two_to_the_power_of(levels_count - 1 - level);
+        }
+
+        std::size_t leaf_in_memory_of(void* block) const
+        {
+            return std::size_t(value_of_pointer(block) - start) / LEAF_SIZE -
+                   leaves_before_memory;
+        }
+
+        void record_level_of(void* block, std::size_t level)
+        {
+            if (block_levels != nullptr)
+            {
+                block_levels[leaf_in_memory_of(block)] =
+                    static_cast<unsigned char>(level);
+            }
+        }
+
+        std::size_t non_empty_levels_above(std::size_t level) const
+        {
+            return non_empty_levels.load(std::memory_order_relaxed) &
+                   (two_to_the_power_of(level) - 1);
+        }
 
         std::size_t level_for_block_with_power_of_two_size(
             std::size_t s
@@ -125,13 +415,44 @@ namespace allocator
         void clear()
         {
             free_lists = nullptr;
+            block_levels = nullptr;
+        }
+
+        std::size_t offset_to_alignment(std::size_t alignment) const
+        {
+            // Blocks of at least `alignment` bytes lie at multiples of
+            // their size from the logical start, so they are all off by
+            // the same number of bytes from the requested alignment.
+            return (alignment - std::size_t(start) % alignment) % alignment;
+        }
+
+        static std::size_t size_for_aligned_block(std::size_t size,
+                                                  std::size_t alignment,
+                                                  std::size_t offset)
+        {
+            return std::max(size + offset, alignment);
         }
 
     private:
-        static const std::size_t LEAF_SIZE = 128;
+        static const std::size_t LEAF_SIZE = LeafSize;
         static const std::size_t MIN_LEVELS_COUNT = 2;
-        static const std::size_t ALIGNMENT_REQUIREMENT =
-            alignof(std::max_align_t);
+        static const std::size_t BATCH_ENTRY_LEVEL_BITS = 6;
+        static const std::size_t ALIGNMENT_REQUIREMENT = Alignment;
+        static const std::size_t METADATA_ALIGNMENT =
+            alignof(FreeList) > alignof(BitMap::Word) ?
+            alignof(FreeList) :
+            alignof(BitMap::Word);
+
+        static_assert(is_power_of_two(LEAF_SIZE),
+                      "The leaf size must be a power of two!");
+        static_assert(is_power_of_two(ALIGNMENT_REQUIREMENT),
+                      "The alignment must be a power of two!");
+        static_assert(ALIGNMENT_REQUIREMENT <= LEAF_SIZE,
+                      "Leaves must be aligned when the first one is!");
+        static_assert(ALIGNMENT_REQUIREMENT >= alignof(std::uintptr_t),
+                      "Free blocks must be aligned for their list links!");
+        static_assert(LEAF_SIZE >= FreeList::LINKS_SIZE,
+                      "A leaf must be able to hold its free list links!");
 
     private:
         PtrValueType start;
@@ -140,8 +461,1647 @@ namespace allocator
         FreeList* free_lists;
         BitMap split_map;
         BitMap free_map;
+        unsigned char* block_levels;
+        std::size_t leaves_before_memory;
+        std::atomic<std::size_t> non_empty_levels;
+        std::size_t purge_threshold;
     };
 
+
+    template <std::size_t LeafSize, std::size_t Alignment, class Stats>
+    BasicBuddyAllocator<LeafSize, Alignment, Stats>::BasicBuddyAllocator() :
+        free_lists(nullptr),
+        block_levels(nullptr),
+        leaves_before_memory(0),
+        non_empty_levels(0),
+        purge_threshold(0)
+    {
+    }
+
+
+    template <std::size_t LeafSize, std::size_t Alignment, class Stats>
+    BasicBuddyAllocator<LeafSize, Alignment, Stats>::BasicBuddyAllocator(
+        void* memory,
+        std::size_t size,
+        LevelLookup lookup,
+        MemoryContents contents
+    ) :
+        BasicBuddyAllocator{}
+    {
+        verify_pointer_is_not_null(memory);
+        const auto memory_descriptor =
+            set_logical_start_size_and_levels_count(memory, size);
+        this->stats().record_creation(levels_count, this->size);
+        const auto free_memory_start =
+            create_data_structures(memory_descriptor, lookup, contents);
+        initialise_data_structures(free_memory_start);
+    }
+
+
+    template <std::size_t LeafSize, std::size_t Alignment, class Stats>
+    BasicBuddyAllocator<LeafSize, Alignment, Stats>::BasicBuddyAllocator(
+        void* memory,
+        std::size_t size,
+        void* metadata,
+        std::size_t metadata_size,
+        LevelLookup lookup,
+        MemoryContents metadata_contents
+    ) :
+        BasicBuddyAllocator{}
+    {
+        verify_pointer_is_not_null(memory);
+        verify_pointer_is_not_null(metadata);
+        const auto memory_descriptor =
+            set_logical_start_size_and_levels_count(memory, size);
+
+        if (metadata_size < required_metadata_size(size, lookup))
+        {
+            throw InsufficientMemory{ "Insufficient memory for metadata!" };
+        }
+
+        this->stats().record_creation(levels_count, this->size);
+        create_external_data_structures(metadata,
+                                        memory_descriptor,
+                                        lookup,
+                                        metadata_contents);
+        initialise_data_structures(memory_descriptor.start);
+    }
+
+
+    template <std::size_t LeafSize, std::size_t Alignment, class Stats>
+    void
+    BasicBuddyAllocator<LeafSize, Alignment, Stats>::verify_pointer_is_not_null(
+        void* memory
+    )
+    {
+        if (memory == nullptr)
+        {
+            throw std::invalid_argument{ "Expected a pointer to memory!" };
+        }
+    }
+
+
+    template <std::size_t LeafSize, std::size_t Alignment, class Stats>
+    typename BasicBuddyAllocator<LeafSize, Alignment, Stats>::MemoryDescriptor
+    BasicBuddyAllocator<LeafSize, Alignment, Stats>::set_logical_start_size_and_levels_count(
+        void* memory,
+        std::size_t size
+    )
+    {
+        const auto aligned_memory = first_aligned_address_within(memory, size);
+        auto actual_size = std::size_t(size - subtract(aligned_memory, memory));
+        const auto wasted_bytes_at_end = actual_size % LEAF_SIZE;
+        actual_size -= wasted_bytes_at_end;
+
+        set_size(actual_size);
+        set_start(aligned_memory, actual_size);
+        set_levels_count();
+
+        return { aligned_memory, actual_size, wasted_bytes_at_end };
+    }
+
+
+    template <std::size_t LeafSize, std::size_t Alignment, class Stats>
+    void*
+    BasicBuddyAllocator<LeafSize, Alignment, Stats>::first_aligned_address_within(
+        void* memory,
+        std::size_t size
+    )
+    {
+        const auto result = std::align(ALIGNMENT_REQUIREMENT,
+                                       LEAF_SIZE,
+                                       memory,
+                                       size);
+
+        if (result != nullptr)
+        {
+            return result;
+        }
+        else
+        {
+            throw InsufficientMemory{};
+        }
+    }
+
+
+    template <std::size_t LeafSize, std::size_t Alignment, class Stats>
+    std::size_t
+    BasicBuddyAllocator<LeafSize, Alignment, Stats>::subtract(void* a,
+                                                              void* b)
+    {
+        assert(a >= b);
+
+        return value_of_pointer(a) - value_of_pointer(b);
+    }
+
+
+    template <std::size_t LeafSize, std::size_t Alignment, class Stats>
+    void
+    BasicBuddyAllocator<LeafSize, Alignment, Stats>::set_size(
+        std::size_t actual_size
+    )
+    {
+        assert(actual_size >= LEAF_SIZE);
+        size = next_power_of_two(actual_size);
+    }
+
+
+    template <std::size_t LeafSize, std::size_t Alignment, class Stats>
+    void
+    BasicBuddyAllocator<LeafSize, Alignment, Stats>::set_start(
+        void* actual_start,
+        std::size_t actual_size
+    )
+    {
+        const auto logical_memory_size = std::size_t(size - actual_size);
+        start = value_of_pointer(actual_start) - logical_memory_size;
+    }
+
+
+    template <std::size_t LeafSize, std::size_t Alignment, class Stats>
+    void BasicBuddyAllocator<LeafSize, Alignment, Stats>::set_levels_count()
+    {
+        levels_count = log2(size / LEAF_SIZE) + 1;
+
+        if (levels_count < MIN_LEVELS_COUNT)
+        {
+            throw InsufficientMemory{};
+        }
+    }
+
+
+    template <std::size_t LeafSize, std::size_t Alignment, class Stats>
+    void*
+    BasicBuddyAllocator<LeafSize, Alignment, Stats>::create_data_structures(
+        const MemoryDescriptor& memory,
+        LevelLookup lookup,
+        MemoryContents contents
+    )
+    {
+        const auto free_memory_start =
+            create_maps(create_free_lists(memory), contents);
+
+        return lookup == LevelLookup::level_map ?
+               create_level_map(free_memory_start, memory) :
+               free_memory_start;
+    }
+
+
+    template <std::size_t LeafSize, std::size_t Alignment, class Stats>
+    typename BasicBuddyAllocator<LeafSize, Alignment, Stats>::MemoryDescriptor
+    BasicBuddyAllocator<LeafSize, Alignment, Stats>::create_free_lists(
+        const MemoryDescriptor& memory
+    )
+    {
+        const auto size_per_list = compute_size_per_list(memory);
+        const auto size_for_lists = levels_count * size_per_list;
+
+        if (size_for_lists < memory.size)
+        {
+            free_lists = new (memory.start) FreeList[levels_count];
+
+            return { add_to(memory.start, size_for_lists),
+                     memory.size - size_for_lists,
+                     memory.wasted_bytes_at_end };
+        }
+        else
+        {
+            throw InsufficientMemory{};
+        }
+    }
+
+
+    template <std::size_t LeafSize, std::size_t Alignment, class Stats>
+    std::size_t
+    BasicBuddyAllocator<LeafSize, Alignment, Stats>::compute_size_per_list(
+        const MemoryDescriptor& memory
+    )
+    {
+        const auto size_of_list = sizeof(FreeList);
+
+        assert(size_of_list < memory.size);
+        auto first_list_end = add_to(memory.start, size_of_list);
+        auto available_space = std::size_t(memory.size - size_of_list);
+        const auto second_list = std::align(alignof(FreeList),
+                                            size_of_list,
+                                            first_list_end,
+                                            available_space);
+        assert(second_list != nullptr);
+
+        return subtract(second_list, memory.start);
+    }
+
+
+    template <std::size_t LeafSize, std::size_t Alignment, class Stats>
+    void*
+    BasicBuddyAllocator<LeafSize, Alignment, Stats>::create_maps(
+        const MemoryDescriptor& memory,
+        MemoryContents contents
+    )
+    {
+        const auto bit_map_size_in_bytes = maps_storage_size(levels_count);
+        const auto maps_start = determine_maps_storage(
+            2 * bit_map_size_in_bytes,
+            memory
+        );
+        create_maps_at(maps_start, contents);
+
+        return add_to(
+            memory.start,
+            maps_start == memory.start ?
+            2 * bit_map_size_in_bytes : 0
+        );
+    }
+
+
+    template <std::size_t LeafSize, std::size_t Alignment, class Stats>
+    void
+    BasicBuddyAllocator<LeafSize, Alignment, Stats>::create_maps_at(
+        unsigned char* maps_start,
+        MemoryContents contents
+    )
+    {
+        const auto bit_map_size = two_to_the_power_of(levels_count - 1);
+        const auto free_map_start =
+            maps_start + maps_storage_size(levels_count);
+
+        // Both maps start cleared, so zero-filled memory needs no writes
+        // and the pages of the maps only become resident once the blocks
+        // they describe are split.
+        if (contents == MemoryContents::zero_filled)
+        {
+            split_map = BitMap::over_zero_filled(maps_start, bit_map_size - 1);
+            free_map = BitMap::over_zero_filled(free_map_start, bit_map_size);
+        }
+        else
+        {
+            split_map = BitMap(maps_start, bit_map_size - 1);
+            free_map = BitMap(free_map_start, bit_map_size);
+        }
+
+        free_map.flip(0);
+    }
+
+
+    template <std::size_t LeafSize, std::size_t Alignment, class Stats>
+    void
+    BasicBuddyAllocator<LeafSize, Alignment, Stats>::create_external_data_structures(
+        void* metadata,
+        const MemoryDescriptor& memory,
+        LevelLookup lookup,
+        MemoryContents contents
+    )
+    {
+        const auto lists_start = metadata_lists_start(metadata);
+        const auto maps_start = maps_within(metadata);
+        free_lists = new (lists_start) FreeList[levels_count];
+        create_maps_at(maps_start, contents);
+        set_level_map_within(maps_start, memory, lookup);
+    }
+
+
+    template <std::size_t LeafSize, std::size_t Alignment, class Stats>
+    void
+    BasicBuddyAllocator<LeafSize, Alignment, Stats>::attach(
+        void* memory,
+        std::size_t size,
+        void* metadata,
+        LevelLookup lookup
+    )
+    {
+        // Takes over metadata created for the same block by another
+        // object, possibly in another process, without writing to it.
+        assert(!manages_memory());
+        const auto memory_descriptor =
+            set_logical_start_size_and_levels_count(memory, size);
+        this->stats().record_creation(levels_count, this->size);
+        const auto maps_start = maps_within(metadata);
+        const auto bit_map_size = two_to_the_power_of(levels_count - 1);
+        free_lists = static_cast<FreeList*>(metadata_lists_start(metadata));
+        split_map = BitMap::over_existing(maps_start, bit_map_size - 1);
+        free_map = BitMap::over_existing(
+            maps_start + maps_storage_size(levels_count),
+            bit_map_size
+        );
+        set_level_map_within(maps_start, memory_descriptor, lookup);
+    }
+
+
+    template <std::size_t LeafSize, std::size_t Alignment, class Stats>
+    unsigned char*
+    BasicBuddyAllocator<LeafSize, Alignment, Stats>::maps_within(
+        void* metadata
+    )
+    {
+        return static_cast<unsigned char*>(
+            add_to(metadata_lists_start(metadata),
+                   lists_storage_size(levels_count))
+        );
+    }
+
+
+    template <std::size_t LeafSize, std::size_t Alignment, class Stats>
+    void
+    BasicBuddyAllocator<LeafSize, Alignment, Stats>::set_level_map_within(
+        unsigned char* maps_start,
+        const MemoryDescriptor& memory,
+        LevelLookup lookup
+    )
+    {
+        if (lookup == LevelLookup::level_map)
+        {
+            block_levels = maps_start + 2 * maps_storage_size(levels_count);
+            leaves_before_memory = (size - memory.size) / LEAF_SIZE;
+        }
+    }
+
+
+    template <std::size_t LeafSize, std::size_t Alignment, class Stats>
+    void*
+    BasicBuddyAllocator<LeafSize, Alignment, Stats>::create_level_map(
+        void* free_memory_start,
+        const MemoryDescriptor& memory
+    )
+    {
+        // A byte per leaf of the physical block, holding the level of the
+        // allocated block starting at that leaf. Entries for leaves which
+        // do not start an allocated block are never read, so the map needs
+        // no initialisation.
+        const auto leaves_count = memory.size / LEAF_SIZE;
+        const auto used_size = subtract(free_memory_start, memory.start);
+
+        if (used_size + leaves_count >= memory.size)
+        {
+            throw InsufficientMemory{};
+        }
+
+        block_levels = static_cast<unsigned char*>(free_memory_start);
+        leaves_before_memory = (size - memory.size) / LEAF_SIZE;
+
+        return add_to(free_memory_start, leaves_count);
+    }
+
+
+    template <std::size_t LeafSize, std::size_t Alignment, class Stats>
+    unsigned char*
+    BasicBuddyAllocator<LeafSize, Alignment, Stats>::determine_maps_storage(
+        std::size_t maps_size,
+        const MemoryDescriptor& memory
+    )
+    {
+        auto result = static_cast<void*>(nullptr);
+
+        if (maps_size <= memory.wasted_bytes_at_end)
+        {
+            result = add_to(memory.start, memory.size);
+        }
+        else if (maps_size < memory.size)
+        {
+            result = memory.start;
+        }
+        else
+        {
+            throw InsufficientMemory{};
+        }
+
+        return reinterpret_cast<unsigned char*>(result);
+    }
+
+
+    template <std::size_t LeafSize, std::size_t Alignment, class Stats>
+    void
+    BasicBuddyAllocator<LeafSize, Alignment, Stats>::initialise_data_structures(
+        void* free_memory_start
+    )
+    {
+        const auto preallocated_size =
+            value_of_pointer(free_memory_start) - start;
+
+        // With external metadata and a power of two size nothing precedes
+        // the free memory, so the root is the only free block.
+        if (preallocated_size == 0)
+        {
+            LevelLocks no_locks;
+            mark_levels_as_non_empty(1, no_locks);
+            free_lists[0].insert(as_pointer(start));
+            this->stats().record_insertion(0);
+
+            return;
+        }
+
+        const auto first_leaf = first_index_at(levels_count - 1);
+        const auto last_leaf_to_allocate =
+            first_leaf + size_in_leaves(preallocated_size) - 1;
+        preallocate_leaves_until(last_leaf_to_allocate);
+    }
+
+
+    template <std::size_t LeafSize, std::size_t Alignment, class Stats>
+    void
+    BasicBuddyAllocator<LeafSize, Alignment, Stats>::preallocate_leaves_until(
+        std::size_t leaf
+    )
+    {
+        mark_blocks_as_allocated_until(leaf, levels_count - 1);
+
+        preallocate_leaves_parents_until(
+            parent_of(leaf),
+            leaf
+        );
+    }
+
+
+    template <std::size_t LeafSize, std::size_t Alignment, class Stats>
+    void
+    BasicBuddyAllocator<LeafSize, Alignment, Stats>::mark_blocks_as_allocated_until(
+        std::size_t index,
+        std::size_t level
+    )
+    {
+        if (is_even(to_level_index(index, level)))
+        {
+            flip_free_map_at(index);
+        }
+    }
+
+
+    template <std::size_t LeafSize, std::size_t Alignment, class Stats>
+    void
+    BasicBuddyAllocator<LeafSize, Alignment, Stats>::flip_free_map_at(
+        std::size_t index
+    )
+    {
+        free_map.flip(free_map_index_for(index));
+    }
+
+
+    template <std::size_t LeafSize, std::size_t Alignment, class Stats>
+    bool
+    BasicBuddyAllocator<LeafSize, Alignment, Stats>::free_map_at(
+        std::size_t index
+    ) const
+    {
+        return free_map.at(free_map_index_for(index));
+    }
+
+
+    template <std::size_t LeafSize, std::size_t Alignment, class Stats>
+    void
+    BasicBuddyAllocator<LeafSize, Alignment, Stats>::preallocate_leaves_parents_until(
+        std::size_t index,
+        std::size_t last_preallocated_leaf
+    )
+    {
+        auto level = int(levels_count - 2);
+        auto last_block_to_allocate = index;
+        auto last_allocated_child = last_preallocated_leaf;
+
+        while (level >= 0)
+        {
+            mark_blocks_as_split_until(last_block_to_allocate, level);
+            mark_blocks_as_allocated_until(last_block_to_allocate, level);
+            insert_free_blocks_at(level + 1,
+                                  last_allocated_child,
+                                  last_block_to_allocate);
+
+            --level;
+            last_allocated_child = last_block_to_allocate;
+            last_block_to_allocate = parent_of(last_block_to_allocate);
+        }
+    }
+
+
+    template <std::size_t LeafSize, std::size_t Alignment, class Stats>
+    void
+    BasicBuddyAllocator<LeafSize, Alignment, Stats>::mark_blocks_as_split_until(
+        std::size_t index,
+        std::size_t level
+    )
+    {
+        assert(level < levels_count - 1);
+
+        split_map.flip_range(first_index_at(level), index + 1);
+    }
+
+
+    template <std::size_t LeafSize, std::size_t Alignment, class Stats>
+    void
+    BasicBuddyAllocator<LeafSize, Alignment, Stats>::insert_free_blocks_at(
+        std::size_t level,
+        std::size_t last_allocated_block,
+        std::size_t last_allocated_parent
+    )
+    {
+        assert(level < levels_count);
+        const auto right_child = right_child_of(last_allocated_parent);
+
+        if (right_child > last_allocated_block)
+        {
+            LevelLocks no_locks;
+            mark_levels_as_non_empty(two_to_the_power_of(level), no_locks);
+            free_lists[level].insert(
+                to_address(right_child, level)
+            );
+            this->stats().record_insertion(level);
+        }
+    }
+
+
+    template <std::size_t LeafSize, std::size_t Alignment, class Stats>
+    void*
+    BasicBuddyAllocator<LeafSize, Alignment, Stats>::to_address(
+        std::size_t index,
+        std::size_t level
+    ) const
+    {
+        const auto preceding_blocks_count =
+            index - first_index_at(level);
+
+        return as_pointer(start +
+                          preceding_blocks_count * size_at(level));
+    }
+
+
+    template <std::size_t LeafSize, std::size_t Alignment, class Stats>
+    BasicBuddyAllocator<LeafSize, Alignment, Stats>::BasicBuddyAllocator(
+        BasicBuddyAllocator&& source
+    ) :
+        StatsStorage<Stats>(std::move(source.stats())),
+        start(source.start),
+        size(source.size),
+        levels_count(source.levels_count),
+        free_lists(source.free_lists),
+        split_map(std::move(source.split_map)),
+        free_map(std::move(source.free_map)),
+        block_levels(source.block_levels),
+        leaves_before_memory(source.leaves_before_memory),
+        non_empty_levels(source.non_empty_levels.load()),
+        purge_threshold(source.purge_threshold)
+    {
+        source.clear();
+    }
+
+
+    template <std::size_t LeafSize, std::size_t Alignment, class Stats>
+    BasicBuddyAllocator<LeafSize, Alignment, Stats>&
+    BasicBuddyAllocator<LeafSize, Alignment, Stats>::operator=(
+        BasicBuddyAllocator&& rhs
+    )
+    {
+        if (this != &rhs)
+        {
+            auto copy = std::move(rhs);
+            swap_contents_with(copy);
+        }
+
+        return *this;
+    }
+
+
+    template <std::size_t LeafSize, std::size_t Alignment, class Stats>
+    void
+    BasicBuddyAllocator<LeafSize, Alignment, Stats>::swap_contents_with(
+        BasicBuddyAllocator& other
+    )
+    {
+        std::swap(this->start, other.start);
+        std::swap(this->size, other.size);
+        std::swap(this->levels_count, other.levels_count);
+        std::swap(this->free_lists, other.free_lists);
+        std::swap(this->split_map, other.split_map);
+        std::swap(this->free_map, other.free_map);
+        std::swap(this->block_levels, other.block_levels);
+        std::swap(this->leaves_before_memory, other.leaves_before_memory);
+        other.non_empty_levels.store(
+            this->non_empty_levels.exchange(other.non_empty_levels.load())
+        );
+        std::swap(this->purge_threshold, other.purge_threshold);
+        std::swap(this->stats(), other.stats());
+    }
+
+
+    template <std::size_t LeafSize, std::size_t Alignment, class Stats>
+    void* BasicBuddyAllocator<LeafSize, Alignment, Stats>::allocate(
+        std::size_t size
+    )
+    {
+        auto block = static_cast<void*>(nullptr);
+
+        if (manages_memory() && size != 0)
+        {
+            const auto level = level_for_block_with(size);
+
+            if (level != -1)
+            {
+                assert(level >= 0);
+                assert(std::size_t(level) < levels_count);
+                LevelLocks no_locks;
+                block = allocate_block_at(level, no_locks);
+            }
+            else
+            {
+                this->stats().record_failure();
+            }
+        }
+
+        return block;
+    }
+
+
+    template <std::size_t LeafSize, std::size_t Alignment, class Stats>
+    void* BasicBuddyAllocator<LeafSize, Alignment, Stats>::allocate(
+        std::size_t size,
+        std::size_t alignment
+    )
+    {
+        verify_alignment(alignment);
+
+        if (alignment <= ALIGNMENT_REQUIREMENT)
+        {
+            return allocate(size);
+        }
+
+        auto block = static_cast<void*>(nullptr);
+
+        if (manages_memory() && size != 0)
+        {
+            if (size <= this->size)
+            {
+                const auto offset = offset_to_alignment(alignment);
+                block = allocate(
+                    size_for_aligned_block(size, alignment, offset)
+                );
+
+                if (block != nullptr)
+                {
+                    block = add_to(block, offset);
+                }
+            }
+            else
+            {
+                this->stats().record_failure();
+            }
+        }
+
+        return block;
+    }
+
+
+    template <std::size_t LeafSize, std::size_t Alignment, class Stats>
+    void
+    BasicBuddyAllocator<LeafSize, Alignment, Stats>::verify_alignment(
+        std::size_t alignment
+    )
+    {
+        if (!is_power_of_two(alignment))
+        {
+            throw std::invalid_argument{
+                "Expected the alignment to be a power of two!"
+            };
+        }
+    }
+
+
+    template <std::size_t LeafSize, std::size_t Alignment, class Stats>
+    int
+    BasicBuddyAllocator<LeafSize, Alignment, Stats>::level_for_block_with(
+        std::size_t size
+    ) const
+    {
+        assert(size > 0);
+
+        if (size <= LEAF_SIZE)
+        {
+            return levels_count - 1;
+        }
+        else if (size <= this->size)
+        {
+            return level_for_block_with_power_of_two_size(
+                next_power_of_two(size)
+            );
+        }
+        else
+        {
+            return -1;
+        }
+    }
+
+
+    template <std::size_t LeafSize, std::size_t Alignment, class Stats>
+    void*
+    BasicBuddyAllocator<LeafSize, Alignment, Stats>::allocate_block_at(
+        std::size_t level,
+        LevelLocks& locks
+    )
+    {
+        auto current_level = level;
+        locks.acquire_for(current_level);
+
+        while (free_lists[current_level].is_empty())
+        {
+            mark_level_as_empty(current_level, locks);
+            const auto candidates = non_empty_levels_above(current_level);
+
+            if (candidates == 0)
+            {
+                this->stats().record_failure();
+
+                return nullptr;
+            }
+
+            current_level = log2(candidates);
+            locks.acquire_for(current_level);
+        }
+
+        const auto result = free_lists[current_level].extract();
+        this->stats().record_removal(current_level);
+        flip_free_map_at(index_of(result, current_level));
+        split(result, current_level, level, locks);
+        record_level_of(result, level);
+        this->stats().record_allocation(level);
+
+        return result;
+    }
+
+
+    template <std::size_t LeafSize, std::size_t Alignment, class Stats>
+    void
+    BasicBuddyAllocator<LeafSize, Alignment, Stats>::split(
+        void* block,
+        std::size_t level,
+        std::size_t target_level,
+        LevelLocks& locks
+    )
+    {
+        assert(level <= target_level);
+
+        if (level < target_level)
+        {
+            mark_levels_as_non_empty(two_to_the_power_of(target_level + 1) -
+                                     two_to_the_power_of(level + 1),
+                                     locks);
+        }
+
+        // The block is split down to the target level, keeping the left
+        // half each time and freeing the right one.
+        while (level < target_level)
+        {
+            assert(locks.hold_lock_for(level) &&
+                   locks.hold_lock_for(level + 1));
+            split_map.flip(index_of(block, level));
+            this->stats().record_split();
+            ++level;
+            free_lists[level].insert(add_to(block, size_at(level)));
+            this->stats().record_insertion(level);
+            flip_free_map_at(index_of(block, level));
+        }
+    }
+
+
+    template <std::size_t LeafSize, std::size_t Alignment, class Stats>
+    void
+    BasicBuddyAllocator<LeafSize, Alignment, Stats>::split_off_tail(
+        void* block,
+        std::size_t level,
+        std::size_t size,
+        LevelLocks& locks
+    )
+    {
+        // The block is halved until only the leaves the request needs are
+        // left allocated. A right half past them is freed, a left half
+        // within them stays allocated as a piece of its own. The pieces
+        // follow each other in decreasing size, one per set bit of the
+        // size in leaves, so a block takes less than a leaf more than was
+        // requested.
+        auto needed = size_in_leaves(size) * LEAF_SIZE;
+        assert(needed <= size_at(level));
+
+        if (needed == size_at(level))
+        {
+            return;
+        }
+
+        this->stats().record_deallocation(level);
+
+        while (needed != size_at(level))
+        {
+            assert(locks.hold_lock_for(level) &&
+                   locks.hold_lock_for(level + 1));
+            split_map.flip(index_of(block, level));
+            this->stats().record_split();
+            ++level;
+            const auto half = size_at(level);
+
+            if (needed <= half)
+            {
+                mark_levels_as_non_empty(two_to_the_power_of(level), locks);
+                free_lists[level].insert(add_to(block, half));
+                this->stats().record_insertion(level);
+                flip_free_map_at(index_of(block, level));
+            }
+            else
+            {
+                record_level_of(block, level);
+                this->stats().record_allocation(level);
+                needed -= half;
+                block = add_to(block, half);
+            }
+        }
+
+        record_level_of(block, level);
+        this->stats().record_allocation(level);
+    }
+
+
+    template <std::size_t LeafSize, std::size_t Alignment, class Stats>
+    template <class Function>
+    void
+    BasicBuddyAllocator<LeafSize, Alignment, Stats>::for_each_piece_of(
+        void* block,
+        std::size_t size,
+        Function function
+    ) const
+    {
+        auto remaining = size_in_leaves(size) * LEAF_SIZE;
+
+        while (remaining != 0)
+        {
+            const auto piece_size = two_to_the_power_of(log2(remaining));
+            function(block,
+                     level_for_block_with_power_of_two_size(piece_size));
+            block = add_to(block, piece_size);
+            remaining -= piece_size;
+        }
+    }
+
+
+    template <std::size_t LeafSize, std::size_t Alignment, class Stats>
+    std::size_t
+    BasicBuddyAllocator<LeafSize, Alignment, Stats>::level_of_last_piece_of(
+        std::size_t size
+    ) const
+    {
+        const auto leaves = size_in_leaves(size);
+
+        return level_for_block_with_power_of_two_size(
+            (leaves & (~leaves + 1)) * LEAF_SIZE
+        );
+    }
+
+
+    template <std::size_t LeafSize, std::size_t Alignment, class Stats>
+    void* BasicBuddyAllocator<LeafSize, Alignment, Stats>::allocate_exact(
+        std::size_t size
+    )
+    {
+        auto block = static_cast<void*>(nullptr);
+
+        if (manages_memory() && size != 0)
+        {
+            const auto level = level_for_block_with(size);
+
+            if (level != -1)
+            {
+                LevelLocks no_locks;
+                block = allocate_block_at(level, no_locks);
+
+                if (block != nullptr)
+                {
+                    split_off_tail(block, level, size, no_locks);
+                }
+            }
+            else
+            {
+                this->stats().record_failure();
+            }
+        }
+
+        return block;
+    }
+
+
+    template <std::size_t LeafSize, std::size_t Alignment, class Stats>
+    void BasicBuddyAllocator<LeafSize, Alignment, Stats>::deallocate_exact(
+        void* block,
+        std::size_t size
+    )
+    {
+        if (manages_memory() && block != nullptr)
+        {
+            LevelLocks no_locks;
+            for_each_piece_of(block, size, [this, &no_locks](void* piece,
+                                                             std::size_t level)
+            {
+                this->stats().record_deallocation(level);
+                free(piece, level, no_locks);
+            });
+        }
+    }
+
+
+    template <std::size_t LeafSize, std::size_t Alignment, class Stats>
+    void
+    BasicBuddyAllocator<LeafSize, Alignment, Stats>::mark_levels_as_non_empty(
+        std::size_t levels,
+        const LevelLocks& locks
+    )
+    {
+        // A level's bit is set before a block is inserted into its list and
+        // is only cleared once a search finds the list empty, under the
+        // level's lock. So a list is never non-empty while its bit is down
+        // and the searches may read the mask without locks. Other levels'
+        // bits may be changed concurrently, hence the atomic operations
+        // when the locks are shared.
+        const auto non_empty = non_empty_levels.load(std::memory_order_relaxed);
+
+        if ((non_empty & levels) != levels)
+        {
+            if (locks.are_shared())
+            {
+                non_empty_levels.fetch_or(levels);
+            }
+            else
+            {
+                non_empty_levels.store(non_empty | levels,
+                                       std::memory_order_relaxed);
+            }
+        }
+    }
+
+
+    template <std::size_t LeafSize, std::size_t Alignment, class Stats>
+    void
+    BasicBuddyAllocator<LeafSize, Alignment, Stats>::mark_level_as_empty(
+        std::size_t level,
+        const LevelLocks& locks
+    )
+    {
+        assert(free_lists[level].is_empty());
+        const auto bit = two_to_the_power_of(level);
+        const auto non_empty = non_empty_levels.load(std::memory_order_relaxed);
+
+        if ((non_empty & bit) != 0)
+        {
+            if (locks.are_shared())
+            {
+                non_empty_levels.fetch_and(~bit);
+            }
+            else
+            {
+                non_empty_levels.store(non_empty & ~bit,
+                                       std::memory_order_relaxed);
+            }
+        }
+    }
+
+
+    template <std::size_t LeafSize, std::size_t Alignment, class Stats>
+    std::size_t
+    BasicBuddyAllocator<LeafSize, Alignment, Stats>::index_of(
+        void* ptr,
+        std::size_t level
+    ) const
+    {
+        return first_index_at(level) + index_at(level, ptr);
+    }
+
+
+    template <std::size_t LeafSize, std::size_t Alignment, class Stats>
+    std::size_t
+    BasicBuddyAllocator<LeafSize, Alignment, Stats>::index_at(std::size_t level,
+                                                              void* ptr) const
+    {
+        return (value_of_pointer(ptr) - start) / size_at(level);
+    }
+
+
+    template <std::size_t LeafSize, std::size_t Alignment, class Stats>
+    void BasicBuddyAllocator<LeafSize, Alignment, Stats>::deallocate(
+        void* block
+    )
+    {
+        if (manages_memory() && block != nullptr)
+        {
+            LevelLocks no_locks;
+            const auto level = level_of(block, no_locks);
+            this->stats().record_deallocation(level);
+            free(block, level, no_locks);
+        }
+    }
+
+
+    template <std::size_t LeafSize, std::size_t Alignment, class Stats>
+    std::size_t
+    BasicBuddyAllocator<LeafSize, Alignment, Stats>::level_of(
+        void* p,
+        LevelLocks& locks
+    ) const
+    {
+        return block_levels != nullptr ?
+               block_levels[leaf_in_memory_of(p)] :
+               level_in_split_map_of(p, locks);
+    }
+
+
+    template <std::size_t LeafSize, std::size_t Alignment, class Stats>
+    std::size_t
+    BasicBuddyAllocator<LeafSize, Alignment, Stats>::level_in_split_map_of(
+        void* p,
+        LevelLocks& locks
+    ) const
+    {
+        auto level = levels_count - 1;
+        auto index = index_of(p, level);
+
+        while (level > 0)
+        {
+            // A parent's split bit is only flipped with the locks of its
+            // children's level held too, so holding that lock is enough
+            // to read it.
+            locks.acquire_for(level);
+            const auto parent = parent_of(index);
+
+            if (split_map.at(parent))
+            {
+                break;
+            }
+            else
+            {
+                --level;
+                index = parent;
+            }
+        }
+
+        return level;
+    }
+
+
+    template <std::size_t LeafSize, std::size_t Alignment, class Stats>
+    void
+    BasicBuddyAllocator<LeafSize, Alignment, Stats>::free(void* block,
+                                                          std::size_t level,
+                                                          LevelLocks& locks)
+    {
+        assert(block != nullptr);
+        assert(level < levels_count);
+
+        free(block, level, index_of(block, level), locks);
+    }
+
+
+    template <std::size_t LeafSize, std::size_t Alignment, class Stats>
+    void
+    BasicBuddyAllocator<LeafSize, Alignment, Stats>::free(void* block,
+                                                          std::size_t level,
+                                                          std::size_t index,
+                                                          LevelLocks& locks)
+    {
+        locks.acquire_for(level);
+
+        // While the buddy is free too, both are merged into their parent
+        // which is then freed in the same way.
+        while (free_map_at(index))
+        {
+            assert(level > 0);
+            const auto block_size = size_at(level);
+
+            if (is_even(index))
+            {
+                block = subtract_from(block, block_size);
+                free_lists[level].remove(block);
+            }
+            else
+            {
+                free_lists[level].remove(add_to(block, block_size));
+            }
+
+            this->stats().record_removal(level);
+            flip_free_map_at(index);
+            index = parent_of(index);
+            locks.acquire_for(--level);
+            assert(locks.hold_lock_for(level + 1));
+            split_map.flip(index);
+            this->stats().record_merge();
+        }
+
+        mark_levels_as_non_empty(two_to_the_power_of(level), locks);
+        free_lists[level].insert(block);
+        this->stats().record_insertion(level);
+        flip_free_map_at(index);
+
+        if (purge_threshold != 0 && size_at(level) >= purge_threshold)
+        {
+            purge(block, level);
+        }
+    }
+
+
+    template <std::size_t LeafSize, std::size_t Alignment, class Stats>
+    std::size_t
+    BasicBuddyAllocator<LeafSize, Alignment, Stats>::trim(
+        std::size_t min_block_size
+    )
+    {
+        LevelLocks no_locks;
+
+        return manages_memory() ? trim(min_block_size, no_locks) : 0;
+    }
+
+
+    template <std::size_t LeafSize, std::size_t Alignment, class Stats>
+    std::size_t
+    BasicBuddyAllocator<LeafSize, Alignment, Stats>::trim(
+        std::size_t min_block_size,
+        LevelLocks& locks
+    )
+    {
+        auto levels = std::size_t(0);
+
+        while (levels < levels_count && size_at(levels) >= min_block_size)
+        {
+            ++levels;
+        }
+
+        if (levels == 0)
+        {
+            return 0;
+        }
+
+        locks.acquire_for(levels - 1);
+        locks.acquire_for(0);
+        auto purged = std::size_t(0);
+
+        for (auto level = std::size_t(0); level < levels; ++level)
+        {
+            free_lists[level].for_each([this, level, &purged](void* block)
+            {
+                purged += purge(block, level);
+            });
+        }
+
+        return purged;
+    }
+
+
+    template <std::size_t LeafSize, std::size_t Alignment, class Stats>
+    std::size_t
+    BasicBuddyAllocator<LeafSize, Alignment, Stats>::purge(void* block,
+                                                           std::size_t level)
+    {
+#if defined(__VIRTUAL_MEMORY_AVAILABLE__)
+        // The free list links in the first bytes of the block must survive,
+        // so the page holding them is kept.
+        const auto purged =
+            purge_pages_within(add_to(block, FreeList::LINKS_SIZE),
+                               size_at(level) - FreeList::LINKS_SIZE);
+        this->stats().record_purge(purged);
+
+        return purged;
+#else
+        return 0;
+#endif
+    }
+
+
+    template <std::size_t LeafSize, std::size_t Alignment, class Stats>
+    void
+    BasicBuddyAllocator<LeafSize, Alignment, Stats>::deallocate(
+        void* block,
+        std::size_t size
+    )
+    {
+        if (manages_memory() && block != nullptr)
+        {
+            const auto level =
+                level_for_block_with(size);
+            assert(level >= 0);
+            this->stats().record_deallocation(level);
+            LevelLocks no_locks;
+            free(block, level, no_locks);
+        }
+    }
+
+
+    template <std::size_t LeafSize, std::size_t Alignment, class Stats>
+    void
+    BasicBuddyAllocator<LeafSize, Alignment, Stats>::deallocate(
+        void* block,
+        std::size_t size,
+        std::size_t alignment
+    )
+    {
+        assert(is_power_of_two(alignment));
+
+        if (alignment <= ALIGNMENT_REQUIREMENT)
+        {
+            deallocate(block, size);
+        }
+        else if (manages_memory() && block != nullptr)
+        {
+            const auto offset = offset_to_alignment(alignment);
+            deallocate(subtract_from(block, offset),
+                       size_for_aligned_block(size, alignment, offset));
+        }
+    }
+
+
+    template <std::size_t LeafSize, std::size_t Alignment, class Stats>
+    void*
+    BasicBuddyAllocator<LeafSize, Alignment, Stats>::reallocate(
+        void* block,
+        std::size_t old_size,
+        std::size_t new_size
+    )
+    {
+        if (block == nullptr)
+        {
+            return allocate(new_size);
+        }
+        else if (new_size == 0)
+        {
+            deallocate(block, old_size);
+
+            return nullptr;
+        }
+        else if (!manages_memory())
+        {
+            return nullptr;
+        }
+
+        const auto level = level_for_block_with(old_size);
+        const auto new_level = level_for_block_with(new_size);
+        assert(level >= 0);
+        LevelLocks no_locks;
+
+        if (new_level == -1)
+        {
+            this->stats().record_failure();
+
+            return nullptr;
+        }
+        else if (new_level >= level)
+        {
+            shrink(block, level, new_level);
+
+            return block;
+        }
+        else if (grow(block, level, new_level))
+        {
+            return block;
+        }
+
+        const auto result = allocate_block_at(new_level, no_locks);
+
+        if (result != nullptr)
+        {
+            std::memcpy(result, block, old_size);
+            this->stats().record_deallocation(level);
+            free(block, level, no_locks);
+        }
+
+        return result;
+    }
+
+
+    template <std::size_t LeafSize, std::size_t Alignment, class Stats>
+    bool
+    BasicBuddyAllocator<LeafSize, Alignment, Stats>::try_expand_in_place(
+        void* block,
+        std::size_t old_size,
+        std::size_t new_size
+    )
+    {
+        if (!manages_memory() || block == nullptr || new_size == 0)
+        {
+            return false;
+        }
+
+        const auto level = level_for_block_with(old_size);
+        const auto new_level = level_for_block_with(new_size);
+        assert(level >= 0);
+
+        if (new_level == -1)
+        {
+            return false;
+        }
+        else if (new_level >= level)
+        {
+            // The block is freed with the new size from now on, so its
+            // unused halves have to be returned just like when it is
+            // reallocated.
+            shrink(block, level, new_level);
+
+            return true;
+        }
+
+        return grow(block, level, new_level);
+    }
+
+
+    template <std::size_t LeafSize, std::size_t Alignment, class Stats>
+    void
+    BasicBuddyAllocator<LeafSize, Alignment, Stats>::shrink(
+        void* block,
+        std::size_t level,
+        std::size_t target_level
+    )
+    {
+        assert(level <= target_level);
+        LevelLocks no_locks;
+        split(block, level, target_level, no_locks);
+        record_level_of(block, target_level);
+        this->stats().record_deallocation(level);
+        this->stats().record_allocation(target_level);
+    }
+
+
+    template <std::size_t LeafSize, std::size_t Alignment, class Stats>
+    bool
+    BasicBuddyAllocator<LeafSize, Alignment, Stats>::grow(
+        void* block,
+        std::size_t level,
+        std::size_t target_level
+    )
+    {
+        assert(target_level < level);
+
+        // The block keeps its address only while it is the left half of
+        // its parent and it can only take over the parent when the right
+        // half is free as a whole. As the block and its ancestors are not
+        // free, the free map bit of each pair tells whether the right half
+        // is.
+        for (auto l = level; l > target_level; --l)
+        {
+            if (!is_even(index_at(l, block)) ||
+                !free_map_at(index_of(block, l)))
+            {
+                return false;
+            }
+        }
+
+        for (auto l = level; l > target_level; --l)
+        {
+            free_lists[l].remove(add_to(block, size_at(l)));
+            this->stats().record_removal(l);
+            flip_free_map_at(index_of(block, l));
+            split_map.flip(index_of(block, l - 1));
+            this->stats().record_merge();
+        }
+
+        record_level_of(block, target_level);
+        this->stats().record_deallocation(level);
+        this->stats().record_allocation(target_level);
+
+        return true;
+    }
+
+
+
+    template <std::size_t LeafSize, std::size_t Alignment, class Stats>
+    std::size_t
+    BasicBuddyAllocator<LeafSize, Alignment, Stats>::allocate_n(
+        std::size_t size,
+        std::size_t count,
+        void** blocks
+    )
+    {
+        auto allocated = std::size_t(0);
+
+        if (manages_memory() && size != 0)
+        {
+            const auto level = level_for_block_with(size);
+
+            if (level != -1)
+            {
+                LevelLocks no_locks;
+                allocated =
+                    allocate_blocks_at(level, count, blocks, no_locks);
+            }
+            else
+            {
+                this->stats().record_failure();
+            }
+        }
+
+        return allocated;
+    }
+
+
+    template <std::size_t LeafSize, std::size_t Alignment, class Stats>
+    std::size_t
+    BasicBuddyAllocator<LeafSize, Alignment, Stats>::allocate_blocks_at(
+        std::size_t level,
+        std::size_t count,
+        void** blocks,
+        LevelLocks& locks
+    )
+    {
+        auto allocated = std::size_t(0);
+
+        while (allocated < count)
+        {
+            const auto block = allocate_block_at(level, locks);
+
+            if (block != nullptr)
+            {
+                blocks[allocated++] = block;
+            }
+            else
+            {
+                break;
+            }
+        }
+
+        return allocated;
+    }
+
+
+    template <std::size_t LeafSize, std::size_t Alignment, class Stats>
+    void
+    BasicBuddyAllocator<LeafSize, Alignment, Stats>::deallocate_n(
+        void** blocks,
+        std::size_t count
+    )
+    {
+        if (manages_memory())
+        {
+            LevelLocks no_locks;
+            const auto batch = to_batch_entries(blocks, count, no_locks);
+            free_batch(blocks, batch.count, no_locks);
+        }
+    }
+
+
+    template <std::size_t LeafSize, std::size_t Alignment, class Stats>
+    void
+    BasicBuddyAllocator<LeafSize, Alignment, Stats>::deallocate_n(
+        void** blocks,
+        std::size_t count,
+        std::size_t size
+    )
+    {
+        if (manages_memory() && count != 0)
+        {
+            const auto level = level_for_block_with(size);
+            assert(level >= 0);
+            count = to_batch_entries(blocks, count, level);
+            LevelLocks no_locks;
+            free_batch(blocks, count, no_locks);
+        }
+    }
+
+
+    template <std::size_t LeafSize, std::size_t Alignment, class Stats>
+    typename BasicBuddyAllocator<LeafSize, Alignment, Stats>::Batch
+    BasicBuddyAllocator<LeafSize, Alignment, Stats>::to_batch_entries(
+        void** blocks,
+        std::size_t count,
+        LevelLocks& locks
+    ) const
+    {
+        auto batch = Batch{ 0, 0 };
+
+        for (auto i = std::size_t(0); i < count; ++i)
+        {
+            if (blocks[i] != nullptr)
+            {
+                const auto level = level_of(blocks[i], locks);
+                blocks[batch.count++] = to_batch_entry(blocks[i], level);
+                batch.deepest_level = std::max(batch.deepest_level, level);
+            }
+        }
+
+        return batch;
+    }
+
+
+    template <std::size_t LeafSize, std::size_t Alignment, class Stats>
+    std::size_t
+    BasicBuddyAllocator<LeafSize, Alignment, Stats>::to_batch_entries(
+        void** blocks,
+        std::size_t count,
+        std::size_t level
+    ) const
+    {
+        auto entries_count = std::size_t(0);
+
+        for (auto i = std::size_t(0); i < count; ++i)
+        {
+            if (blocks[i] != nullptr)
+            {
+                blocks[entries_count++] = to_batch_entry(blocks[i], level);
+            }
+        }
+
+        return entries_count;
+    }
+
+
+    template <std::size_t LeafSize, std::size_t Alignment, class Stats>
+    void
+    BasicBuddyAllocator<LeafSize, Alignment, Stats>::free_batch(
+        void** entries,
+        std::size_t count,
+        LevelLocks& locks
+    )
+    {
+        // An entry holds the block's offset in leaves in its high bits and
+        // its level in the low ones, so entries are ordered by address.
+        // Sorted, buddies from the batch become neighbours and are merged
+        // with a stack kept at the front of the array, without touching
+        // the free lists or the blocks themselves. Whatever is left is
+        // freed as usual.
+        const auto by_address = [](void* lhs, void* rhs)
+        {
+            return reinterpret_cast<std::uintptr_t>(lhs) <
+                   reinterpret_cast<std::uintptr_t>(rhs);
+        };
+
+        if (!std::is_sorted(entries, entries + count, by_address))
+        {
+            std::sort(entries, entries + count, by_address);
+        }
+
+        for (auto i = std::size_t(0); i < count; ++i)
+        {
+            this->stats().record_deallocation(level_of_batch_entry(entries[i]));
+        }
+
+        auto pending = std::size_t(0);
+
+        for (auto i = std::size_t(0); i < count; ++i)
+        {
+            auto entry = entries[i];
+
+            while (pending != 0 &&
+                   is_left_buddy_of(entries[pending - 1], entry))
+            {
+                entry = merge_with_right_buddy(entries[--pending], locks);
+            }
+
+            entries[pending++] = entry;
+        }
+
+        for (auto i = std::size_t(0); i < pending; ++i)
+        {
+            free(block_of_batch_entry(entries[i]),
+                 level_of_batch_entry(entries[i]),
+                 locks);
+        }
+    }
+
+
+    template <std::size_t LeafSize, std::size_t Alignment, class Stats>
+    bool
+    BasicBuddyAllocator<LeafSize, Alignment, Stats>::is_left_buddy_of(
+        void* left,
+        void* right
+    ) const
+    {
+        const auto level = level_of_batch_entry(left);
+        const auto leaves_in_block = leaves_in_block_at(level);
+        const auto leaves_before_left = leaves_before_batch_entry(left);
+
+        return level > 0 &&
+               level_of_batch_entry(right) == level &&
+               is_even(leaves_before_left / leaves_in_block) &&
+               leaves_before_left + leaves_in_block ==
+                   leaves_before_batch_entry(right);
+    }
+
+
+    template <std::size_t LeafSize, std::size_t Alignment, class Stats>
+    void*
+    BasicBuddyAllocator<LeafSize, Alignment, Stats>::merge_with_right_buddy(
+        void* left,
+        LevelLocks& locks
+    )
+    {
+        const auto parent_level = level_of_batch_entry(left) - 1;
+        const auto leaves_before_parent = leaves_before_batch_entry(left);
+        const auto parent = first_index_at(parent_level) +
+            leaves_before_parent / leaves_in_block_at(parent_level);
+        locks.acquire_for(parent_level);
+        assert(locks.hold_lock_for(parent_level + 1));
+        split_map.flip(parent);
+        this->stats().record_merge();
+
+        return to_batch_entry(leaves_before_parent, parent_level);
+    }
+
+
+    using BuddyAllocator =
+        BasicBuddyAllocator<128, alignof(std::max_align_t)>;
+
+    using BuddyAllocatorWithStats =
+        BasicBuddyAllocator<128, alignof(std::max_align_t), BuddyStats>;
+
+    extern template class
+        BasicBuddyAllocator<128, alignof(std::max_align_t)>;
+
+    extern template class
+        BasicBuddyAllocator<128, alignof(std::max_align_t), BuddyStats>;
+
 }
 
 #endif // __BUDDY_ALLOCATOR_HEADER_INCLUDED__
\ No newline at end of file
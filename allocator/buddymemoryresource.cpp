@@ -0,0 +1,52 @@
+#include "buddymemoryresource.hpp"
+
+#if defined(__BUDDY_MEMORY_RESOURCE_AVAILABLE__)
+
+#include <new>
+
+
+namespace allocator
+{
+    BuddyMemoryResource::BuddyMemoryResource(void* memory,
+                                             std::size_t size,
+                                             LevelLookup lookup) :
+        allocator(memory, size, lookup)
+    {
+    }
+
+
+    void* BuddyMemoryResource::do_allocate(std::size_t bytes,
+                                           std::size_t alignment)
+    {
+        // Memory resources may be asked for zero bytes but must still
+        // return a unique pointer.
+        const auto block =
+            allocator.allocate(bytes != 0 ? bytes : 1, alignment);
+
+        if (block == nullptr)
+        {
+            throw std::bad_alloc{};
+        }
+
+        return block;
+    }
+
+
+    void BuddyMemoryResource::do_deallocate(void* block,
+                                            std::size_t bytes,
+                                            std::size_t alignment)
+    {
+        allocator.deallocate(block, bytes != 0 ? bytes : 1, alignment);
+    }
+
+
+    bool BuddyMemoryResource::do_is_equal(
+        const std::pmr::memory_resource& other
+    ) const noexcept
+    {
+        return this == &other;
+    }
+
+}
+
+#endif
@@ -0,0 +1,47 @@
+#ifndef __BUDDY_MEMORY_RESOURCE_HEADER_INCLUDED__
+#define __BUDDY_MEMORY_RESOURCE_HEADER_INCLUDED__
+
+#if __cplusplus >= 201703L && __has_include(<memory_resource>)
+#define __BUDDY_MEMORY_RESOURCE_AVAILABLE__
+
+#include <cstddef>
+#include <memory_resource>
+
+#include "buddyallocator.hpp"
+
+
+namespace allocator
+{
+    class BuddyMemoryResource : public std::pmr::memory_resource
+    {
+    public:
+        BuddyMemoryResource() = default;
+        BuddyMemoryResource(void* memory,
+                            std::size_t size,
+                            LevelLookup lookup = LevelLookup::split_map);
+        BuddyMemoryResource(const BuddyMemoryResource&) = delete;
+        BuddyMemoryResource& operator=(const BuddyMemoryResource&) = delete;
+
+        bool manages_memory() const
+        {
+            return allocator.manages_memory();
+        }
+
+    private:
+        void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+        void do_deallocate(void* block,
+                           std::size_t bytes,
+                           std::size_t alignment) override;
+        bool do_is_equal(
+            const std::pmr::memory_resource& other
+        ) const noexcept override;
+
+    private:
+        BuddyAllocator allocator;
+    };
+
+}
+
+#endif
+
+#endif // __BUDDY_MEMORY_RESOURCE_HEADER_INCLUDED__
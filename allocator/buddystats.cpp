@@ -0,0 +1,72 @@
+#include "buddystats.hpp"
+
+
+namespace allocator
+{
+    BuddyStats::BuddyStats() :
+        levels(),
+        levels_count(0),
+        bytes_in_use(0),
+        peak_bytes_in_use(0),
+        splits_count(0),
+        merges_count(0),
+        failed_allocations_count(0),
+        purged_bytes(0)
+    {
+    }
+
+
+    void BuddyStats::record_creation(std::size_t levels_count,
+                                     std::size_t size)
+    {
+        assert(levels_count <= MAX_LEVELS_COUNT);
+        *this = BuddyStats{};
+        this->levels_count = levels_count;
+
+        for (auto i = std::size_t(0); i < levels_count; ++i)
+        {
+            levels[i].block_size = size / two_to_the_power_of(i);
+        }
+    }
+
+
+    std::size_t BuddyStats::free_bytes() const
+    {
+        auto result = std::size_t(0);
+
+        for (auto i = std::size_t(0); i < levels_count; ++i)
+        {
+            result += levels[i].free_blocks * levels[i].block_size;
+        }
+
+        return result;
+    }
+
+
+    std::size_t BuddyStats::largest_free_block() const
+    {
+        for (auto i = std::size_t(0); i < levels_count; ++i)
+        {
+            if (levels[i].free_blocks != 0)
+            {
+                return levels[i].block_size;
+            }
+        }
+
+        return 0;
+    }
+
+
+    double BuddyStats::fragmentation() const
+    {
+        // The share of the free memory which cannot be handed out as one
+        // block: 0 when it is all in a single block and approaching 1 as it
+        // is scattered in ever smaller ones.
+        const auto free = free_bytes();
+
+        return free != 0 ?
+               1.0 - double(largest_free_block()) / double(free) :
+               0.0;
+    }
+
+}
@@ -0,0 +1,183 @@
+#ifndef __BUDDY_STATS_HEADER_INCLUDED__
+#define __BUDDY_STATS_HEADER_INCLUDED__
+
+#include <assert.h>
+#include <cstddef>
+
+#include "arithmetic.hpp"
+
+
+namespace allocator
+{
+    class NoStats
+    {
+    public:
+        void record_creation(std::size_t, std::size_t) {}
+        void record_allocation(std::size_t) {}
+        void record_deallocation(std::size_t) {}
+        void record_split() {}
+        void record_merge() {}
+        void record_insertion(std::size_t) {}
+        void record_removal(std::size_t) {}
+        void record_failure() {}
+        void record_purge(std::size_t) {}
+    };
+
+
+    class BuddyStats
+    {
+    public:
+        static const std::size_t MAX_LEVELS_COUNT = SIZE_T_SIZE_IN_BITS;
+
+    public:
+        BuddyStats();
+
+        std::size_t get_levels_count() const
+        {
+            return levels_count;
+        }
+
+        std::size_t block_size_at(std::size_t level) const
+        {
+            return level_at(level).block_size;
+        }
+
+        std::size_t blocks_in_use_at(std::size_t level) const
+        {
+            return level_at(level).blocks_in_use;
+        }
+
+        std::size_t free_blocks_at(std::size_t level) const
+        {
+            return level_at(level).free_blocks;
+        }
+
+        std::size_t bytes_in_use_at(std::size_t level) const
+        {
+            return blocks_in_use_at(level) * block_size_at(level);
+        }
+
+        std::size_t get_bytes_in_use() const
+        {
+            return bytes_in_use;
+        }
+
+        std::size_t get_peak_bytes_in_use() const
+        {
+            return peak_bytes_in_use;
+        }
+
+        std::size_t get_splits_count() const
+        {
+            return splits_count;
+        }
+
+        std::size_t get_merges_count() const
+        {
+            return merges_count;
+        }
+
+        std::size_t get_failed_allocations_count() const
+        {
+            return failed_allocations_count;
+        }
+
+        std::size_t get_purged_bytes() const
+        {
+            return purged_bytes;
+        }
+
+        std::size_t free_bytes() const;
+        std::size_t largest_free_block() const;
+        double fragmentation() const;
+
+        void record_creation(std::size_t levels_count, std::size_t size);
+
+        void record_allocation(std::size_t level)
+        {
+            auto& l = level_at(level);
+            ++l.blocks_in_use;
+            bytes_in_use += l.block_size;
+
+            if (bytes_in_use > peak_bytes_in_use)
+            {
+                peak_bytes_in_use = bytes_in_use;
+            }
+        }
+
+        void record_deallocation(std::size_t level)
+        {
+            auto& l = level_at(level);
+            assert(l.blocks_in_use > 0);
+            --l.blocks_in_use;
+            bytes_in_use -= l.block_size;
+        }
+
+        void record_split()
+        {
+            ++splits_count;
+        }
+
+        void record_merge()
+        {
+            ++merges_count;
+        }
+
+        void record_insertion(std::size_t level)
+        {
+            ++level_at(level).free_blocks;
+        }
+
+        void record_removal(std::size_t level)
+        {
+            assert(level_at(level).free_blocks > 0);
+            --level_at(level).free_blocks;
+        }
+
+        void record_failure()
+        {
+            ++failed_allocations_count;
+        }
+
+        void record_purge(std::size_t bytes)
+        {
+            purged_bytes += bytes;
+        }
+
+    private:
+        struct Level
+        {
+            std::size_t block_size;
+            std::size_t blocks_in_use;
+            std::size_t free_blocks;
+        };
+
+    private:
+        Level& level_at(std::size_t level)
+        {
+            assert(level < levels_count);
+
+            return levels[level];
+        }
+
+        const Level& level_at(std::size_t level) const
+        {
+            assert(level < levels_count);
+
+            return levels[level];
+        }
+
+    private:
+        Level levels[MAX_LEVELS_COUNT];
+        std::size_t levels_count;
+        std::size_t bytes_in_use;
+        std::size_t peak_bytes_in_use;
+        std::size_t splits_count;
+        std::size_t merges_count;
+        std::size_t failed_allocations_count;
+        std::size_t purged_bytes;
+    };
+
+}
+
+#endif // __BUDDY_STATS_HEADER_INCLUDED__
@@ -0,0 +1,261 @@
+#include "concurrentbuddyallocator.hpp"
+
+#include <assert.h>
+#include <utility>
+
+
+namespace allocator
+{
+    ConcurrentBuddyAllocator::ConcurrentBuddyAllocator(
+        void* memory,
+        std::size_t size,
+        LevelLookup lookup,
+        MemoryContents contents
+    ) :
+        allocator(memory, size, lookup, contents),
+        locks(new std::mutex[
+            LevelLocks::groups_count_for(allocator.levels_count)
+        ])
+    {
+    }
+
+
+    ConcurrentBuddyAllocator::ConcurrentBuddyAllocator(
+        void* memory,
+        std::size_t size,
+        void* metadata,
+        std::size_t metadata_size,
+        LevelLookup lookup,
+        MemoryContents metadata_contents
+    ) :
+        allocator(memory,
+                  size,
+                  metadata,
+                  metadata_size,
+                  lookup,
+                  metadata_contents),
+        locks(new std::mutex[
+            LevelLocks::groups_count_for(allocator.levels_count)
+        ])
+    {
+    }
+
+
+    ConcurrentBuddyAllocator::ConcurrentBuddyAllocator(
+        ConcurrentBuddyAllocator&& source
+    ) :
+        ConcurrentBuddyAllocator{}
+    {
+        swap_contents_with(source);
+    }
+
+
+    ConcurrentBuddyAllocator&
+    ConcurrentBuddyAllocator::operator=(ConcurrentBuddyAllocator&& rhs)
+    {
+        if (this != &rhs)
+        {
+            auto copy = std::move(rhs);
+            swap_contents_with(copy);
+        }
+
+        return *this;
+    }
+
+
+    void ConcurrentBuddyAllocator::swap_contents_with(
+        ConcurrentBuddyAllocator& other
+    )
+    {
+        std::swap(this->allocator, other.allocator);
+        std::swap(this->locks, other.locks);
+    }
+
+
+    void* ConcurrentBuddyAllocator::allocate(std::size_t size)
+    {
+        auto block = static_cast<void*>(nullptr);
+
+        if (manages_memory() && size != 0)
+        {
+            const auto level = allocator.level_for_block_with(size);
+
+            if (level != -1)
+            {
+                LevelLocks locks{ this->locks.get() };
+                block = allocator.allocate_block_at(level, locks);
+            }
+        }
+
+        return block;
+    }
+
+
+    void ConcurrentBuddyAllocator::deallocate(void* block)
+    {
+        if (manages_memory() && block != nullptr)
+        {
+            // The level is found first, under the locks of the levels the
+            // split bits are read from. The bits which tell the level
+            // can't change while the block is allocated, so those locks
+            // needn't be held on to while it is freed.
+            const auto level = level_of(block);
+            LevelLocks locks{ this->locks.get() };
+            allocator.free(block, level, locks);
+        }
+    }
+
+
+    void ConcurrentBuddyAllocator::deallocate(void* block, std::size_t size)
+    {
+        if (manages_memory() && block != nullptr)
+        {
+            const auto level = allocator.level_for_block_with(size);
+            assert(level >= 0);
+            LevelLocks locks{ this->locks.get() };
+            allocator.free(block, level, locks);
+        }
+    }
+
+
+    void* ConcurrentBuddyAllocator::allocate_exact(std::size_t size)
+    {
+        auto block = static_cast<void*>(nullptr);
+
+        if (manages_memory() && size != 0)
+        {
+            const auto level = allocator.level_for_block_with(size);
+
+            if (level != -1)
+            {
+                // Splitting off the tail reaches down to the level of the
+                // last piece. Groups are locked from the deepest level up,
+                // so its lock is taken before the block's one.
+                LevelLocks locks{ this->locks.get() };
+                locks.acquire_for(allocator.level_of_last_piece_of(size));
+                block = allocator.allocate_block_at(level, locks);
+
+                if (block != nullptr)
+                {
+                    allocator.split_off_tail(block, level, size, locks);
+                }
+            }
+        }
+
+        return block;
+    }
+
+
+    void ConcurrentBuddyAllocator::deallocate_exact(void* block,
+                                                    std::size_t size)
+    {
+        if (manages_memory() && block != nullptr)
+        {
+            allocator.for_each_piece_of(block, size, [this](void* piece,
+                                                            std::size_t level)
+            {
+                LevelLocks locks{ this->locks.get() };
+                allocator.free(piece, level, locks);
+            });
+        }
+    }
+
+
+
+    std::size_t ConcurrentBuddyAllocator::allocate_n(std::size_t size,
+                                                     std::size_t count,
+                                                     void** blocks)
+    {
+        auto allocated = std::size_t(0);
+
+        if (manages_memory() && size != 0)
+        {
+            const auto level = allocator.level_for_block_with(size);
+
+            if (level != -1)
+            {
+                allocated = allocate_blocks_at(level, count, blocks);
+            }
+        }
+
+        return allocated;
+    }
+
+
+    std::size_t ConcurrentBuddyAllocator::allocate_blocks_at(
+        std::size_t level,
+        std::size_t count,
+        void** blocks
+    )
+    {
+        assert(manages_memory());
+        assert(level < levels_count());
+        LevelLocks locks{ this->locks.get() };
+
+        return allocator.allocate_blocks_at(level, count, blocks, locks);
+    }
+
+
+    void ConcurrentBuddyAllocator::deallocate_n(void** blocks,
+                                                std::size_t count)
+    {
+        if (manages_memory())
+        {
+            // The levels are found under the locks the batch is freed
+            // with, taken from the deepest level up.
+            LevelLocks locks{ this->locks.get() };
+            const auto batch =
+                allocator.to_batch_entries(blocks, count, locks);
+            locks.acquire_for(batch.deepest_level);
+            allocator.free_batch(blocks, batch.count, locks);
+        }
+    }
+
+
+    void ConcurrentBuddyAllocator::deallocate_n(void** blocks,
+                                                std::size_t count,
+                                                std::size_t size)
+    {
+        if (manages_memory() && count != 0)
+        {
+            const auto level = allocator.level_for_block_with(size);
+            assert(level >= 0);
+            deallocate_blocks_at(level, blocks, count);
+        }
+    }
+
+
+    void ConcurrentBuddyAllocator::deallocate_blocks_at(std::size_t level,
+                                                        void** blocks,
+                                                        std::size_t count)
+    {
+        assert(manages_memory());
+        assert(level < levels_count());
+        count = allocator.to_batch_entries(blocks, count, level);
+        LevelLocks locks{ this->locks.get() };
+        locks.acquire_for(level);
+        allocator.free_batch(blocks, count, locks);
+    }
+
+
+    std::size_t ConcurrentBuddyAllocator::level_of(void* block) const
+    {
+        LevelLocks locks{ this->locks.get() };
+
+        return allocator.level_of(block, locks);
+    }
+
+
+    std::size_t ConcurrentBuddyAllocator::trim(std::size_t min_block_size)
+    {
+        if (!manages_memory())
+        {
+            return 0;
+        }
+
+        LevelLocks locks{ this->locks.get() };
+
+        return allocator.trim(min_block_size, locks);
+    }
+
+}
@@ -0,0 +1,93 @@
+#ifndef __CONCURRENT_BUDDY_ALLOCATOR_HEADER_INCLUDED__
+#define __CONCURRENT_BUDDY_ALLOCATOR_HEADER_INCLUDED__
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+
+#include "buddyallocator.hpp"
+
+
+namespace allocator
+{
+    class ConcurrentBuddyAllocator
+    {
+        friend class MagazineCache;
+
+    public:
+        ConcurrentBuddyAllocator() = default;
+        ConcurrentBuddyAllocator(
+            void* memory,
+            std::size_t size,
+            LevelLookup lookup = LevelLookup::split_map,
+            MemoryContents contents = MemoryContents::unknown
+        );
+        ConcurrentBuddyAllocator(
+            void* memory,
+            std::size_t size,
+            void* metadata,
+            std::size_t metadata_size,
+            LevelLookup lookup = LevelLookup::split_map,
+            MemoryContents metadata_contents = MemoryContents::unknown
+        );
+        ConcurrentBuddyAllocator(ConcurrentBuddyAllocator&& source);
+        ConcurrentBuddyAllocator& operator=(ConcurrentBuddyAllocator&& rhs);
+
+        void* allocate(std::size_t size);
+        void deallocate(void* block);
+        void deallocate(void* block, std::size_t size);
+        void* allocate_exact(std::size_t size);
+        void deallocate_exact(void* block, std::size_t size);
+        std::size_t allocate_n(std::size_t size,
+                               std::size_t count,
+                               void** blocks);
+        void deallocate_n(void** blocks, std::size_t count);
+        void deallocate_n(void** blocks,
+                          std::size_t count,
+                          std::size_t size);
+        std::size_t trim(std::size_t min_block_size = 0);
+
+        bool manages_memory() const
+        {
+            return allocator.manages_memory();
+        }
+
+        void set_purge_threshold(std::size_t threshold)
+        {
+            allocator.set_purge_threshold(threshold);
+        }
+
+        std::size_t get_purge_threshold() const
+        {
+            return allocator.get_purge_threshold();
+        }
+
+    private:
+        void swap_contents_with(ConcurrentBuddyAllocator& other);
+        std::size_t allocate_blocks_at(std::size_t level,
+                                       std::size_t count,
+                                       void** blocks);
+        void deallocate_blocks_at(std::size_t level,
+                                  void** blocks,
+                                  std::size_t count);
+
+        int level_for_block_with(std::size_t size) const
+        {
+            return allocator.level_for_block_with(size);
+        }
+
+        std::size_t level_of(void* block) const;
+
+        std::size_t levels_count() const
+        {
+            return allocator.levels_count;
+        }
+
+    private:
+        BuddyAllocator allocator;
+        std::unique_ptr<std::mutex[]> locks;
+    };
+
+}
+
+#endif // __CONCURRENT_BUDDY_ALLOCATOR_HEADER_INCLUDED__
@@ -15,7 +15,9 @@ namespace allocator
 
     void FreeList::swap_contents_with(FreeList& list)
     {
-        std::swap(this->first, list.first);
+        const auto this_first = this->first_block();
+        link_to(this->first, list.first_block());
+        link_to(list.first, this_first);
     }
 
 
@@ -34,22 +36,23 @@ namespace allocator
     void FreeList::insert(void* block)
     {
         validate_alignment_of(block);
-        previous_to(block) = value_of_pointer(nullptr);
-        next_to(block) = value_of_pointer(first);
+        const auto old_first = first_block();
+        link_to(previous_to(block), nullptr);
+        link_to(next_to(block), old_first);
 
-        if (!is_empty())
+        if (old_first != nullptr)
         {
-            previous_to(first) = value_of_pointer(block);
+            link_to(previous_to(old_first), block);
         }
 
-        first = block;
+        link_to(first, block);
     }
 
 
     void FreeList::validate_alignment_of(void* block)
     {
         assert(block != nullptr);
-        assert(value_of_pointer(block) % alignof(std::max_align_t) == 0);
+        assert(value_of_pointer(block) % alignof(PtrValueType) == 0);
     }
 
 
@@ -57,22 +60,21 @@ namespace allocator
     {
         assert(!is_empty());
         validate_alignment_of(block);
-        const auto previous = as_pointer(previous_to(block));
+        const auto previous = target_of(previous_to(block));
+        const auto next = target_of(next_to(block));
 
         if (previous != nullptr)
         {
-            next_to(previous) = next_to(block);
+            link_to(next_to(previous), next);
         }
         else
         {
-            first = as_pointer(next_to(block));
+            link_to(first, next);
         }
 
-        const auto next = as_pointer(next_to(block));
-
         if (next != nullptr)
         {
-            previous_to(next) = previous_to(block);
+            link_to(previous_to(next), previous);
         }
     }
 
@@ -80,8 +82,8 @@ namespace allocator
     void* FreeList::extract()
     {
         assert(!is_empty());
-        const auto result = first;
-        remove(first);
+        const auto result = first_block();
+        remove(result);
 
         return result;
     }
@@ -89,14 +91,8 @@ namespace allocator
 
     std::size_t FreeList::get_size() const
     {
-        auto current = first;
         auto size = std::size_t(0);
-
-        while (current != nullptr)
-        {
-            ++size;
-            current = as_pointer(next_to(current));
-        }
+        for_each([&size](void*) { ++size; });
 
         return size;
     }
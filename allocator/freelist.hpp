@@ -11,9 +11,12 @@ namespace allocator
     {
         using PtrValueType = std::uintptr_t;
 
+    public:
+        static const std::size_t LINKS_SIZE = 2 * sizeof(PtrValueType);
+
     public:
         FreeList() :
-            first(nullptr)
+            first(0)
         {
         }
 
@@ -26,12 +29,41 @@ namespace allocator
 
         std::size_t get_size() const;
 
+        template <class Function>
+        void for_each(Function function) const
+        {
+            for (auto block = first_block();
+                 block != nullptr;
+                 block = target_of(next_to(block)))
+            {
+                function(block);
+            }
+        }
+
         bool is_empty() const
         {
-            return first == nullptr;
+            return first == 0;
         }
 
     private:
+        // A link holds the distance from itself to the block it points to
+        // and 0 stands for no block. The list and its blocks thus stay
+        // valid wherever they are mapped, as long as they are mapped
+        // together, for example in memory shared between processes.
+        static void* target_of(const PtrValueType& link)
+        {
+            return link != 0 ?
+                   as_pointer(value_of_pointer(&link) + link) :
+                   nullptr;
+        }
+
+        static void link_to(PtrValueType& link, const void* target)
+        {
+            link = target != nullptr ?
+                   value_of_pointer(target) - value_of_pointer(&link) :
+                   0;
+        }
+
         static PtrValueType& previous_to(void* block)
         {
             return *as_pointer_to_ptr_values(block);
@@ -47,7 +79,7 @@ namespace allocator
             return *(as_pointer_to_ptr_values(block) + 1);
         }
 
-        static PtrValueType value_of_pointer(void* p)
+        static PtrValueType value_of_pointer(const void* p)
         {
             return reinterpret_cast<PtrValueType>(p);
         }
@@ -60,21 +92,17 @@ namespace allocator
         static void validate_alignment_of(void* block);
 
     private:
+        void* first_block() const
+        {
+            return target_of(first);
+        }
+
         void swap_contents_with(FreeList& list);
 
     private:
-        void* first;
+        PtrValueType first;
     };
 
-
-    inline void insert_in(FreeList& list,
-                          void* first_block,
-                          void* second_block)
-    {
-        list.insert(first_block);
-        list.insert(second_block);
-    }
-
 }
 
 #endif // __FREE_LIST_HEADER_INCLUDED__
\ No newline at end of file
@@ -0,0 +1,308 @@
+#include "growablebuddyheap.hpp"
+
+#if defined(__GROWABLE_BUDDY_HEAP_AVAILABLE__)
+
+#include <stdexcept>
+#include <utility>
+
+#include "insufficientmemory.hpp"
+
+
+namespace allocator
+{
+    GrowableBuddyHeap::GrowableBuddyHeap() :
+        reservation(nullptr),
+        chunk_size(0),
+        chunk_shift(0),
+        max_chunks_count(0),
+        lookup(LevelLookup::split_map),
+        committed_count(0),
+        chunks_end(0),
+        current(0),
+        spare(0)
+    {
+    }
+
+
+    GrowableBuddyHeap::GrowableBuddyHeap(std::size_t chunk_size,
+                                         std::size_t max_chunks_count,
+                                         LevelLookup lookup) :
+        GrowableBuddyHeap{}
+    {
+        verify_configuration(chunk_size, max_chunks_count);
+        chunks.reset(new Chunk[max_chunks_count]());
+
+        // The whole address range is reserved up front and aligned to the
+        // chunk size, so the chunk of a block is found with a shift.
+        reservation = static_cast<char*>(
+            reserve_address_space(chunk_size * max_chunks_count, chunk_size)
+        );
+
+        if (reservation == nullptr)
+        {
+            throw InsufficientMemory{ "Could not reserve address space!" };
+        }
+
+        this->chunk_size = chunk_size;
+        this->chunk_shift = log2(chunk_size);
+        this->max_chunks_count = max_chunks_count;
+        this->lookup = lookup;
+        this->current = max_chunks_count;
+        this->spare = max_chunks_count;
+    }
+
+
+    void GrowableBuddyHeap::verify_configuration(std::size_t chunk_size,
+                                                 std::size_t max_chunks_count)
+    {
+        if (!is_power_of_two(chunk_size) || chunk_size < page_size())
+        {
+            throw std::invalid_argument{
+                "Expected a chunk size which is a power of two and at least "
+                "a page!"
+            };
+        }
+
+        if (max_chunks_count == 0 ||
+            max_chunks_count > (~std::size_t(0) >> log2(chunk_size)))
+        {
+            throw std::invalid_argument{
+                "Expected a positive number of chunks fitting in the "
+                "address space!"
+            };
+        }
+    }
+
+
+    GrowableBuddyHeap::GrowableBuddyHeap(GrowableBuddyHeap&& source) :
+        GrowableBuddyHeap{}
+    {
+        swap_contents_with(source);
+    }
+
+
+    GrowableBuddyHeap& GrowableBuddyHeap::operator=(GrowableBuddyHeap&& rhs)
+    {
+        if (this != &rhs)
+        {
+            auto copy = std::move(rhs);
+            swap_contents_with(copy);
+        }
+
+        return *this;
+    }
+
+
+    void GrowableBuddyHeap::swap_contents_with(GrowableBuddyHeap& other)
+    {
+        std::swap(this->reservation, other.reservation);
+        std::swap(this->chunk_size, other.chunk_size);
+        std::swap(this->chunk_shift, other.chunk_shift);
+        std::swap(this->max_chunks_count, other.max_chunks_count);
+        std::swap(this->lookup, other.lookup);
+        std::swap(this->chunks, other.chunks);
+        std::swap(this->committed_count, other.committed_count);
+        std::swap(this->chunks_end, other.chunks_end);
+        std::swap(this->current, other.current);
+        std::swap(this->spare, other.spare);
+    }
+
+
+    GrowableBuddyHeap::~GrowableBuddyHeap()
+    {
+        destroy();
+    }
+
+
+    void GrowableBuddyHeap::destroy()
+    {
+        if (manages_memory())
+        {
+            chunks.reset();
+            release_address_space(reservation, reservation_size());
+            reservation = nullptr;
+        }
+    }
+
+
+    void* GrowableBuddyHeap::allocate(std::size_t size)
+    {
+        if (!manages_memory() || size == 0 || size > max_block_size())
+        {
+            return nullptr;
+        }
+
+        // The chunk which served the last request is tried first, then
+        // the other committed ones and only then a new chunk is committed.
+        if (current != max_chunks_count)
+        {
+            if (const auto block = allocate_from(current, size))
+            {
+                return block;
+            }
+        }
+
+        for (auto i = std::size_t(0); i < chunks_end; ++i)
+        {
+            if (i != current && is_committed(i))
+            {
+                if (const auto block = allocate_from(i, size))
+                {
+                    current = i;
+
+                    return block;
+                }
+            }
+        }
+
+        const auto index = commit_chunk();
+
+        if (index == max_chunks_count)
+        {
+            return nullptr;
+        }
+
+        const auto block = allocate_from(index, size);
+
+        if (block != nullptr)
+        {
+            current = index;
+        }
+        else
+        {
+            release_chunk(index);
+        }
+
+        return block;
+    }
+
+
+    void* GrowableBuddyHeap::allocate_from(std::size_t index,
+                                           std::size_t size)
+    {
+        auto& chunk = chunks[index];
+        const auto block = chunk.allocator.allocate(size);
+
+        if (block != nullptr)
+        {
+            ++chunk.blocks_in_use;
+
+            if (index == spare)
+            {
+                spare = max_chunks_count;
+            }
+        }
+
+        return block;
+    }
+
+
+    std::size_t GrowableBuddyHeap::commit_chunk()
+    {
+        auto index = std::size_t(0);
+
+        while (index < max_chunks_count && is_committed(index))
+        {
+            ++index;
+        }
+
+        if (index == max_chunks_count ||
+            !commit(chunk_start(index), chunk_size))
+        {
+            return max_chunks_count;
+        }
+
+        // Fresh and decommitted pages read as zeros, so only the pages the
+        // bookkeeping needs are touched here.
+        chunks[index].allocator = BuddyAllocator(chunk_start(index),
+                                                 chunk_size,
+                                                 lookup,
+                                                 MemoryContents::zero_filled);
+        chunks[index].blocks_in_use = 0;
+        ++committed_count;
+
+        if (index >= chunks_end)
+        {
+            chunks_end = index + 1;
+        }
+
+        return index;
+    }
+
+
+    void GrowableBuddyHeap::deallocate(void* block)
+    {
+        if (manages_memory() && block != nullptr)
+        {
+            const auto index = chunk_index_of(block);
+            chunks[index].allocator.deallocate(block);
+            on_deallocation_from(index);
+        }
+    }
+
+
+    void GrowableBuddyHeap::deallocate(void* block, std::size_t size)
+    {
+        if (manages_memory() && block != nullptr)
+        {
+            const auto index = chunk_index_of(block);
+            chunks[index].allocator.deallocate(block, size);
+            on_deallocation_from(index);
+        }
+    }
+
+
+    void GrowableBuddyHeap::on_deallocation_from(std::size_t index)
+    {
+        assert(chunks[index].blocks_in_use > 0);
+
+        if (--chunks[index].blocks_in_use != 0)
+        {
+            return;
+        }
+
+        // A single free chunk is kept committed so that a heap whose usage
+        // oscillates around a chunk boundary does not map and unmap memory
+        // on every call. Any other chunk which becomes free is released.
+        if (spare == max_chunks_count)
+        {
+            spare = index;
+        }
+        else
+        {
+            release_chunk(index);
+        }
+    }
+
+
+    void GrowableBuddyHeap::release_free_chunks()
+    {
+        if (spare != max_chunks_count)
+        {
+            release_chunk(spare);
+            spare = max_chunks_count;
+        }
+    }
+
+
+    void GrowableBuddyHeap::release_chunk(std::size_t index)
+    {
+        assert(chunks[index].blocks_in_use == 0);
+        chunks[index].allocator = BuddyAllocator{};
+        decommit(chunk_start(index), chunk_size);
+        --committed_count;
+
+        if (index == current)
+        {
+            current = max_chunks_count;
+        }
+
+        while (chunks_end > 0 && !is_committed(chunks_end - 1))
+        {
+            --chunks_end;
+        }
+    }
+
+}
+
+#endif
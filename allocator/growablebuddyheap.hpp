@@ -0,0 +1,135 @@
+#ifndef __GROWABLE_BUDDY_HEAP_HEADER_INCLUDED__
+#define __GROWABLE_BUDDY_HEAP_HEADER_INCLUDED__
+
+#include "virtualmemory.hpp"
+
+#if defined(__VIRTUAL_MEMORY_AVAILABLE__)
+#define __GROWABLE_BUDDY_HEAP_AVAILABLE__
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "buddyallocator.hpp"
+
+
+namespace allocator
+{
+    class GrowableBuddyHeap
+    {
+        struct Chunk
+        {
+            BuddyAllocator allocator;
+            std::size_t blocks_in_use;
+        };
+
+    public:
+        static const std::size_t DEFAULT_MAX_CHUNKS_COUNT =
+            sizeof(void*) >= 8 ? 1024 : 16;
+
+    public:
+        GrowableBuddyHeap();
+        explicit GrowableBuddyHeap(
+            std::size_t chunk_size,
+            std::size_t max_chunks_count = DEFAULT_MAX_CHUNKS_COUNT,
+            LevelLookup lookup = LevelLookup::split_map
+        );
+        GrowableBuddyHeap(GrowableBuddyHeap&& source);
+        GrowableBuddyHeap& operator=(GrowableBuddyHeap&& rhs);
+        ~GrowableBuddyHeap();
+
+        void* allocate(std::size_t size);
+        void deallocate(void* block);
+        void deallocate(void* block, std::size_t size);
+        void release_free_chunks();
+
+        bool manages_memory() const
+        {
+            return reservation != nullptr;
+        }
+
+        bool owns(const void* block) const
+        {
+            return manages_memory() &&
+                   value_of(block) - value_of(reservation) <
+                       reservation_size();
+        }
+
+        std::size_t get_chunk_size() const
+        {
+            return chunk_size;
+        }
+
+        std::size_t get_max_chunks_count() const
+        {
+            return max_chunks_count;
+        }
+
+        std::size_t committed_chunks_count() const
+        {
+            return committed_count;
+        }
+
+        std::size_t max_block_size() const
+        {
+            // The bookkeeping of a chunk takes its first leaves, so the
+            // right half is the biggest block a chunk always has free.
+            return chunk_size / 2;
+        }
+
+    private:
+        static void verify_configuration(std::size_t chunk_size,
+                                         std::size_t max_chunks_count);
+
+        static std::uintptr_t value_of(const void* p)
+        {
+            return reinterpret_cast<std::uintptr_t>(p);
+        }
+
+    private:
+        void* allocate_from(std::size_t index, std::size_t size);
+        std::size_t commit_chunk();
+        void release_chunk(std::size_t index);
+        void on_deallocation_from(std::size_t index);
+        void swap_contents_with(GrowableBuddyHeap& other);
+        void destroy();
+
+        std::size_t chunk_index_of(const void* block) const
+        {
+            assert(owns(block));
+            return (value_of(block) - value_of(reservation)) >> chunk_shift;
+        }
+
+        char* chunk_start(std::size_t index) const
+        {
+            return reservation + (index << chunk_shift);
+        }
+
+        std::size_t reservation_size() const
+        {
+            return max_chunks_count << chunk_shift;
+        }
+
+        bool is_committed(std::size_t index) const
+        {
+            return chunks[index].allocator.manages_memory();
+        }
+
+    private:
+        char* reservation;
+        std::size_t chunk_size;
+        std::size_t chunk_shift;
+        std::size_t max_chunks_count;
+        LevelLookup lookup;
+        std::unique_ptr<Chunk[]> chunks;
+        std::size_t committed_count;
+        std::size_t chunks_end;
+        std::size_t current;
+        std::size_t spare;
+    };
+
+}
+
+#endif
+
+#endif // __GROWABLE_BUDDY_HEAP_HEADER_INCLUDED__
@@ -0,0 +1,111 @@
+#include "hugepagearena.hpp"
+
+#if defined(__HUGE_PAGE_ARENA_AVAILABLE__)
+
+#include <stdexcept>
+#include <utility>
+
+#include "insufficientmemory.hpp"
+
+
+namespace allocator
+{
+    HugePageArena::HugePageArena() :
+        memory(nullptr),
+        size(0),
+        pages(HugePages::none)
+    {
+    }
+
+
+    HugePageArena::HugePageArena(std::size_t size,
+                                 HugePages preferred,
+                                 LevelLookup lookup) :
+        HugePageArena{}
+    {
+        if (size == 0)
+        {
+            throw std::invalid_argument{ "Expected a positive arena size!" };
+        }
+
+        // An arena of whole huge pages starting at a huge page boundary
+        // has a logical start aligned to a huge page as well, so every
+        // block of at least a huge page is backed by whole huge pages.
+        const auto rounded_size = round_to_huge_pages(size);
+        const auto mapping = map_huge_pages(rounded_size, preferred);
+
+        if (mapping.memory == nullptr)
+        {
+            throw InsufficientMemory{ "Could not map the arena!" };
+        }
+
+        this->memory = mapping.memory;
+        this->size = rounded_size;
+        this->pages = mapping.pages;
+        allocator = BuddyAllocator(memory,
+                                   rounded_size,
+                                   lookup,
+                                   MemoryContents::zero_filled);
+    }
+
+
+    std::size_t HugePageArena::round_to_huge_pages(std::size_t size)
+    {
+        const auto remainder = size % HUGE_PAGE_SIZE;
+
+        if (remainder != 0 && size > ~std::size_t(0) - HUGE_PAGE_SIZE)
+        {
+            throw InsufficientMemory{};
+        }
+
+        return remainder != 0 ? size + (HUGE_PAGE_SIZE - remainder) : size;
+    }
+
+
+    HugePageArena::HugePageArena(HugePageArena&& source) :
+        HugePageArena{}
+    {
+        swap_contents_with(source);
+    }
+
+
+    HugePageArena& HugePageArena::operator=(HugePageArena&& rhs)
+    {
+        if (this != &rhs)
+        {
+            auto copy = std::move(rhs);
+            swap_contents_with(copy);
+        }
+
+        return *this;
+    }
+
+
+    void HugePageArena::swap_contents_with(HugePageArena& other)
+    {
+        std::swap(this->memory, other.memory);
+        std::swap(this->size, other.size);
+        std::swap(this->pages, other.pages);
+        std::swap(this->allocator, other.allocator);
+    }
+
+
+    HugePageArena::~HugePageArena()
+    {
+        destroy();
+    }
+
+
+    void HugePageArena::destroy()
+    {
+        if (manages_memory())
+        {
+            allocator = BuddyAllocator{};
+            release_address_space(memory, size);
+            memory = nullptr;
+        }
+    }
+
+}
+
+#endif
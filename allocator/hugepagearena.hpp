@@ -0,0 +1,72 @@
+#ifndef __HUGE_PAGE_ARENA_HEADER_INCLUDED__
+#define __HUGE_PAGE_ARENA_HEADER_INCLUDED__
+
+#include "virtualmemory.hpp"
+
+#if defined(__VIRTUAL_MEMORY_AVAILABLE__)
+#define __HUGE_PAGE_ARENA_AVAILABLE__
+
+#include <cstddef>
+
+#include "buddyallocator.hpp"
+
+
+namespace allocator
+{
+    class HugePageArena
+    {
+    public:
+        HugePageArena();
+        explicit HugePageArena(
+            std::size_t size,
+            HugePages preferred = HugePages::huge_tlb,
+            LevelLookup lookup = LevelLookup::split_map
+        );
+        HugePageArena(HugePageArena&& source);
+        HugePageArena& operator=(HugePageArena&& rhs);
+        ~HugePageArena();
+
+        BuddyAllocator& get_allocator()
+        {
+            return allocator;
+        }
+
+        const BuddyAllocator& get_allocator() const
+        {
+            return allocator;
+        }
+
+        bool manages_memory() const
+        {
+            return memory != nullptr;
+        }
+
+        HugePages get_pages() const
+        {
+            return pages;
+        }
+
+        std::size_t get_size() const
+        {
+            return size;
+        }
+
+    private:
+        static std::size_t round_to_huge_pages(std::size_t size);
+
+    private:
+        void swap_contents_with(HugePageArena& other);
+        void destroy();
+
+    private:
+        void* memory;
+        std::size_t size;
+        HugePages pages;
+        BuddyAllocator allocator;
+    };
+
+}
+
+#endif
+
+#endif // __HUGE_PAGE_ARENA_HEADER_INCLUDED__
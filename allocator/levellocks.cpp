@@ -0,0 +1,51 @@
+#include "levellocks.hpp"
+
+#include <assert.h>
+
+
+namespace allocator
+{
+    LevelLocks::LevelLocks(std::mutex* locks) :
+        LevelLocks{}
+    {
+        assert(locks != nullptr);
+        this->locks = locks;
+    }
+
+
+    LevelLocks::~LevelLocks()
+    {
+        if (holds_locks)
+        {
+            for (auto group = lowest_locked_group;
+                 group <= highest_locked_group;
+                 ++group)
+            {
+                locks[group].unlock();
+            }
+        }
+    }
+
+
+    void LevelLocks::lock_groups_until(std::size_t group)
+    {
+        if (!holds_locks)
+        {
+            locks[group].lock();
+            lowest_locked_group = highest_locked_group = group;
+            holds_locks = true;
+        }
+        else
+        {
+            // Groups are always locked from the deepest levels towards
+            // the root, which is what rules out deadlocks.
+            assert(group <= highest_locked_group);
+
+            while (lowest_locked_group > group)
+            {
+                locks[--lowest_locked_group].lock();
+            }
+        }
+    }
+
+}
@@ -0,0 +1,89 @@
+#ifndef __LEVEL_LOCKS_HEADER_INCLUDED__
+#define __LEVEL_LOCKS_HEADER_INCLUDED__
+
+#include <cstddef>
+#include <mutex>
+
+#include "arithmetic.hpp"
+#include "bitmap.hpp"
+
+
+namespace allocator
+{
+    class LevelLocks
+    {
+    public:
+        LevelLocks() :
+            locks(nullptr),
+            lowest_locked_group(0),
+            highest_locked_group(0),
+            holds_locks(false)
+        {
+        }
+
+        explicit LevelLocks(std::mutex* locks);
+        LevelLocks(const LevelLocks&) = delete;
+        LevelLocks& operator=(const LevelLocks&) = delete;
+        ~LevelLocks();
+
+        void acquire_for(std::size_t level)
+        {
+            if (locks != nullptr)
+            {
+                lock_groups_until(group_of(level));
+            }
+        }
+
+        bool are_shared() const
+        {
+            return locks != nullptr;
+        }
+
+        bool hold_lock_for(std::size_t level) const
+        {
+            return locks == nullptr ||
+                   (holds_locks &&
+                    lowest_locked_group <= group_of(level) &&
+                    group_of(level) <= highest_locked_group);
+        }
+
+        static std::size_t groups_count_for(std::size_t levels_count)
+        {
+            return group_of(levels_count - 1) + 1;
+        }
+
+        static std::size_t group_of(std::size_t level)
+        {
+            return level < LEVELS_SHARING_A_GROUP ?
+                   0 :
+                   level - LEVELS_SHARING_A_GROUP + 1;
+        }
+
+    private:
+        void lock_groups_until(std::size_t group);
+
+    private:
+        // The free map's bits for levels [0, LEVELS_SHARING_A_GROUP) share
+        // a single word so these levels need to be guarded by the same
+        // lock, while each deeper level's bits fill words of their own.
+        // This is log2(bits in word) + 1.
+        //
+        // The split map's bits are shifted by one, so the last word of
+        // each level also holds the first bit of the next one. That word
+        // is still guarded by a single lock because a split bit at level
+        // K is only ever flipped with the locks of both K and K + 1 held,
+        // which the split and merge paths assert. Reading a split bit at
+        // level K needs only the lock of K + 1.
+        static const std::size_t LEVELS_SHARING_A_GROUP =
+            log2(BitMap::WORD_SIZE_IN_BITS) + 1;
+
+    private:
+        std::mutex* locks;
+        std::size_t lowest_locked_group;
+        std::size_t highest_locked_group;
+        bool holds_locks;
+    };
+
+}
+
+#endif // __LEVEL_LOCKS_HEADER_INCLUDED__
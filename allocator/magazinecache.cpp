@@ -0,0 +1,221 @@
+#include "magazinecache.hpp"
+
+#include <algorithm>
+#include <assert.h>
+#include <stdexcept>
+#include <utility>
+
+
+namespace allocator
+{
+    MagazineCache::MagazineCache() :
+        allocator(nullptr),
+        capacity(0),
+        cached_levels(0),
+        levels_count(0),
+        magazines(),
+        statistics()
+    {
+    }
+
+
+    MagazineCache::MagazineCache(ConcurrentBuddyAllocator& allocator,
+                                 std::size_t capacity,
+                                 std::size_t cached_levels) :
+        MagazineCache{}
+    {
+        verify_configuration(capacity, cached_levels);
+
+        if (allocator.manages_memory())
+        {
+            this->allocator = &allocator;
+            this->capacity = capacity;
+            this->levels_count = allocator.levels_count();
+            this->cached_levels = std::min(cached_levels, levels_count);
+            create_magazines();
+        }
+    }
+
+
+    void MagazineCache::verify_configuration(std::size_t capacity,
+                                             std::size_t cached_levels)
+    {
+        if (capacity == 0)
+        {
+            throw std::invalid_argument{
+                "Expected a positive magazine capacity!"
+            };
+        }
+
+        if (cached_levels == 0 || cached_levels > MAX_CACHED_LEVELS)
+        {
+            throw std::invalid_argument{
+                "Expected between 1 and 3 cached levels!"
+            };
+        }
+    }
+
+
+    void MagazineCache::create_magazines()
+    {
+        slots.reset(new void*[cached_levels * capacity]);
+
+        for (auto i = std::size_t(0); i < cached_levels; ++i)
+        {
+            magazines[i] = { slots.get() + i * capacity, 0 };
+        }
+    }
+
+
+    MagazineCache::MagazineCache(MagazineCache&& source) :
+        MagazineCache{}
+    {
+        swap_contents_with(source);
+    }
+
+
+    MagazineCache& MagazineCache::operator=(MagazineCache&& rhs)
+    {
+        if (this != &rhs)
+        {
+            auto copy = std::move(rhs);
+            swap_contents_with(copy);
+        }
+
+        return *this;
+    }
+
+
+    void MagazineCache::swap_contents_with(MagazineCache& other)
+    {
+        std::swap(this->allocator, other.allocator);
+        std::swap(this->capacity, other.capacity);
+        std::swap(this->cached_levels, other.cached_levels);
+        std::swap(this->levels_count, other.levels_count);
+        std::swap(this->slots, other.slots);
+        std::swap(this->magazines, other.magazines);
+        std::swap(this->statistics, other.statistics);
+    }
+
+
+    MagazineCache::~MagazineCache()
+    {
+        flush();
+    }
+
+
+    void MagazineCache::flush()
+    {
+        for (auto i = std::size_t(0); i < cached_levels; ++i)
+        {
+            auto& magazine = magazines[i];
+            drain(magazine, levels_count - 1 - i, magazine.size);
+        }
+    }
+
+
+    void* MagazineCache::allocate(std::size_t size)
+    {
+        if (!is_attached() || size == 0)
+        {
+            return nullptr;
+        }
+
+        const auto level = allocator->level_for_block_with(size);
+
+        if (level == -1 || !is_cached(level))
+        {
+            return allocator->allocate(size);
+        }
+
+        auto& magazine = magazine_for(level);
+
+        if (magazine.size != 0)
+        {
+            ++statistics.hits;
+        }
+        else
+        {
+            ++statistics.misses;
+            refill(magazine, level);
+
+            if (magazine.size == 0)
+            {
+                return nullptr;
+            }
+        }
+
+        return magazine.blocks[--magazine.size];
+    }
+
+
+    void MagazineCache::refill(Magazine& magazine, std::size_t level)
+    {
+        assert(magazine.size == 0);
+        magazine.size = allocator->allocate_blocks_at(level,
+                                                      batch_size(),
+                                                      magazine.blocks);
+        ++statistics.refills;
+    }
+
+
+    void MagazineCache::deallocate(void* block)
+    {
+        if (is_attached() && block != nullptr)
+        {
+            deallocate_at(block, allocator->level_of(block));
+        }
+    }
+
+
+    void MagazineCache::deallocate(void* block, std::size_t size)
+    {
+        if (is_attached() && block != nullptr)
+        {
+            const auto level = allocator->level_for_block_with(size);
+            assert(level >= 0);
+            deallocate_at(block, level);
+        }
+    }
+
+
+    void MagazineCache::deallocate_at(void* block, std::size_t level)
+    {
+        if (is_cached(level))
+        {
+            auto& magazine = magazine_for(level);
+
+            if (magazine.size == capacity)
+            {
+                drain(magazine, level, batch_size());
+            }
+
+            magazine.blocks[magazine.size++] = block;
+        }
+        else
+        {
+            allocator->deallocate_blocks_at(level, &block, 1);
+        }
+    }
+
+
+    void MagazineCache::drain(Magazine& magazine,
+                              std::size_t level,
+                              std::size_t count)
+    {
+        assert(count <= magazine.size);
+
+        if (count != 0)
+        {
+            // The oldest blocks are returned to the allocator, the most
+            // recently freed (and likely cache-hot) ones stay.
+            allocator->deallocate_blocks_at(level, magazine.blocks, count);
+            std::move(magazine.blocks + count,
+                      magazine.blocks + magazine.size,
+                      magazine.blocks);
+            magazine.size -= count;
+            ++statistics.drains;
+        }
+    }
+
+}
@@ -0,0 +1,97 @@
+#ifndef __MAGAZINE_CACHE_HEADER_INCLUDED__
+#define __MAGAZINE_CACHE_HEADER_INCLUDED__
+
+#include <cstddef>
+#include <memory>
+
+#include "concurrentbuddyallocator.hpp"
+
+
+namespace allocator
+{
+    class MagazineCache
+    {
+        struct Magazine
+        {
+            void** blocks;
+            std::size_t size;
+        };
+
+    public:
+        struct Statistics
+        {
+            std::size_t hits;
+            std::size_t misses;
+            std::size_t refills;
+            std::size_t drains;
+        };
+
+    public:
+        static const std::size_t DEFAULT_CAPACITY = 64;
+        static const std::size_t MAX_CACHED_LEVELS = 3;
+
+    public:
+        MagazineCache();
+        explicit MagazineCache(ConcurrentBuddyAllocator& allocator,
+                               std::size_t capacity = DEFAULT_CAPACITY,
+                               std::size_t cached_levels = 1);
+        MagazineCache(MagazineCache&& source);
+        MagazineCache& operator=(MagazineCache&& rhs);
+        ~MagazineCache();
+
+        void* allocate(std::size_t size);
+        void deallocate(void* block);
+        void deallocate(void* block, std::size_t size);
+        void flush();
+
+        bool is_attached() const
+        {
+            return allocator != nullptr;
+        }
+
+        const Statistics& get_statistics() const
+        {
+            return statistics;
+        }
+
+    private:
+        static void verify_configuration(std::size_t capacity,
+                                         std::size_t cached_levels);
+
+    private:
+        void create_magazines();
+        void deallocate_at(void* block, std::size_t level);
+        void refill(Magazine& magazine, std::size_t level);
+        void drain(Magazine& magazine,
+                   std::size_t level,
+                   std::size_t count);
+        void swap_contents_with(MagazineCache& other);
+
+        bool is_cached(std::size_t level) const
+        {
+            return level + cached_levels >= levels_count;
+        }
+
+        Magazine& magazine_for(std::size_t level)
+        {
+            return magazines[levels_count - 1 - level];
+        }
+
+        std::size_t batch_size() const
+        {
+            return capacity / 2 + capacity % 2;
+        }
+
+    private:
+        ConcurrentBuddyAllocator* allocator;
+        std::size_t capacity;
+        std::size_t cached_levels;
+        std::size_t levels_count;
+        std::unique_ptr<void*[]> slots;
+        Magazine magazines[MAX_CACHED_LEVELS];
+        Statistics statistics;
+    };
+
+}
+
+#endif // __MAGAZINE_CACHE_HEADER_INCLUDED__
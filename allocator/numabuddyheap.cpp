@@ -0,0 +1,217 @@
+#include "numabuddyheap.hpp"
+
+#if defined(__NUMA_BUDDY_HEAP_AVAILABLE__)
+
+#include <assert.h>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+
+#include "insufficientmemory.hpp"
+
+
+namespace allocator
+{
+    NumaBuddyHeap::NumaBuddyHeap() :
+        memory(nullptr),
+        arena_size(0),
+        nodes_count(0),
+        bound_nodes_count(0)
+    {
+    }
+
+
+    NumaBuddyHeap::NumaBuddyHeap(std::size_t arena_size,
+                                 std::size_t nodes_count,
+                                 LevelLookup lookup) :
+        NumaBuddyHeap{}
+    {
+        if (arena_size == 0 || nodes_count == 0)
+        {
+            throw std::invalid_argument{
+                "Expected a positive arena size and number of nodes!"
+            };
+        }
+
+        // Arenas are whole pages, since memory policies apply to pages.
+        const auto remainder = arena_size % page_size();
+
+        if (remainder != 0 && arena_size > ~std::size_t(0) - page_size())
+        {
+            throw InsufficientMemory{};
+        }
+
+        arena_size += remainder != 0 ? page_size() - remainder : 0;
+
+        if (arena_size > ~std::size_t(0) / nodes_count)
+        {
+            throw InsufficientMemory{};
+        }
+
+        arenas.reset(new ConcurrentBuddyAllocator[nodes_count]);
+        memory = reserve_address_space(arena_size * nodes_count, page_size());
+
+        if (memory == nullptr)
+        {
+            throw InsufficientMemory{ "Could not reserve address space!" };
+        }
+
+        this->arena_size = arena_size;
+        this->nodes_count = nodes_count;
+
+        // Each arena is bound before anything touches it, including the
+        // allocator's own data structures at its start. Binding fails for
+        // nodes the machine does not have, whose arenas then take memory
+        // from wherever the kernel places it.
+        for (auto node = std::size_t(0); node < nodes_count; ++node)
+        {
+            if (bind_to_numa_node(arena_of(node), arena_size, node))
+            {
+                ++bound_nodes_count;
+            }
+        }
+
+        if (!commit(memory, arena_size * nodes_count))
+        {
+            destroy();
+            throw InsufficientMemory{ "Could not commit the arenas!" };
+        }
+
+        for (auto node = std::size_t(0); node < nodes_count; ++node)
+        {
+            arenas[node] = ConcurrentBuddyAllocator(
+                arena_of(node),
+                arena_size,
+                lookup,
+                MemoryContents::zero_filled
+            );
+        }
+    }
+
+
+    NumaBuddyHeap::NumaBuddyHeap(NumaBuddyHeap&& source) :
+        NumaBuddyHeap{}
+    {
+        swap_contents_with(source);
+    }
+
+
+    NumaBuddyHeap& NumaBuddyHeap::operator=(NumaBuddyHeap&& rhs)
+    {
+        if (this != &rhs)
+        {
+            auto copy = std::move(rhs);
+            swap_contents_with(copy);
+        }
+
+        return *this;
+    }
+
+
+    void NumaBuddyHeap::swap_contents_with(NumaBuddyHeap& other)
+    {
+        std::swap(this->memory, other.memory);
+        std::swap(this->arena_size, other.arena_size);
+        std::swap(this->nodes_count, other.nodes_count);
+        std::swap(this->bound_nodes_count, other.bound_nodes_count);
+        std::swap(this->arenas, other.arenas);
+    }
+
+
+    NumaBuddyHeap::~NumaBuddyHeap()
+    {
+        destroy();
+    }
+
+
+    void NumaBuddyHeap::destroy()
+    {
+        if (manages_memory())
+        {
+            arenas.reset();
+            release_address_space(memory, arena_size * nodes_count);
+            memory = nullptr;
+        }
+    }
+
+
+    void* NumaBuddyHeap::arena_of(std::size_t node) const
+    {
+        assert(node < nodes_count);
+
+        return static_cast<char*>(memory) + node * arena_size;
+    }
+
+
+    void* NumaBuddyHeap::allocate(std::size_t size)
+    {
+        return allocate(size, current_numa_node());
+    }
+
+
+    void* NumaBuddyHeap::allocate(std::size_t size, std::size_t node)
+    {
+        if (!manages_memory())
+        {
+            return nullptr;
+        }
+
+        // Remote memory is slower but still better than failing, so the
+        // other nodes are tried once the local arena is exhausted.
+        node %= nodes_count;
+
+        for (auto i = std::size_t(0); i < nodes_count; ++i)
+        {
+            const auto block = arenas[(node + i) % nodes_count].allocate(size);
+
+            if (block != nullptr)
+            {
+                return block;
+            }
+        }
+
+        return nullptr;
+    }
+
+
+    void NumaBuddyHeap::deallocate(void* block)
+    {
+        if (block != nullptr)
+        {
+            arenas[node_of(block)].deallocate(block);
+        }
+    }
+
+
+    void NumaBuddyHeap::deallocate(void* block, std::size_t size)
+    {
+        if (block != nullptr)
+        {
+            arenas[node_of(block)].deallocate(block, size);
+        }
+    }
+
+
+    bool NumaBuddyHeap::owns(const void* block) const
+    {
+        const auto address = reinterpret_cast<std::uintptr_t>(block);
+        const auto start = reinterpret_cast<std::uintptr_t>(memory);
+
+        return manages_memory() &&
+               start <= address &&
+               address - start < arena_size * nodes_count;
+    }
+
+
+    std::size_t NumaBuddyHeap::node_of(const void* block) const
+    {
+        assert(owns(block));
+        const auto address = reinterpret_cast<std::uintptr_t>(block);
+        const auto start = reinterpret_cast<std::uintptr_t>(memory);
+
+        return (address - start) / arena_size;
+    }
+
+}
+
+#endif
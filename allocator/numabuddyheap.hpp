@@ -0,0 +1,74 @@
+#ifndef __NUMA_BUDDY_HEAP_HEADER_INCLUDED__
+#define __NUMA_BUDDY_HEAP_HEADER_INCLUDED__
+
+#include "virtualmemory.hpp"
+
+#if defined(__VIRTUAL_MEMORY_AVAILABLE__)
+#define __NUMA_BUDDY_HEAP_AVAILABLE__
+
+#include <cstddef>
+#include <memory>
+
+#include "concurrentbuddyallocator.hpp"
+
+
+namespace allocator
+{
+    class NumaBuddyHeap
+    {
+    public:
+        NumaBuddyHeap();
+        explicit NumaBuddyHeap(
+            std::size_t arena_size,
+            std::size_t nodes_count = numa_nodes_count(),
+            LevelLookup lookup = LevelLookup::split_map
+        );
+        NumaBuddyHeap(NumaBuddyHeap&& source);
+        NumaBuddyHeap& operator=(NumaBuddyHeap&& rhs);
+        ~NumaBuddyHeap();
+
+        void* allocate(std::size_t size);
+        void* allocate(std::size_t size, std::size_t node);
+        void deallocate(void* block);
+        void deallocate(void* block, std::size_t size);
+        bool owns(const void* block) const;
+        std::size_t node_of(const void* block) const;
+
+        bool manages_memory() const
+        {
+            return memory != nullptr;
+        }
+
+        std::size_t get_arena_size() const
+        {
+            return arena_size;
+        }
+
+        std::size_t get_nodes_count() const
+        {
+            return nodes_count;
+        }
+
+        std::size_t get_bound_nodes_count() const
+        {
+            return bound_nodes_count;
+        }
+
+    private:
+        void swap_contents_with(NumaBuddyHeap& other);
+        void destroy();
+        void* arena_of(std::size_t node) const;
+
+    private:
+        void* memory;
+        std::size_t arena_size;
+        std::size_t nodes_count;
+        std::size_t bound_nodes_count;
+        std::unique_ptr<ConcurrentBuddyAllocator[]> arenas;
+    };
+
+}
+
+#endif
+
+#endif // __NUMA_BUDDY_HEAP_HEADER_INCLUDED__
@@ -0,0 +1,180 @@
+#include "ownedbuddyallocator.hpp"
+
+#include <assert.h>
+#include <new>
+#include <utility>
+
+
+namespace allocator
+{
+    OwnedBuddyAllocator::OwnedBuddyAllocator() :
+        owner(std::this_thread::get_id()),
+        remote_frees(nullptr)
+    {
+    }
+
+
+    OwnedBuddyAllocator::OwnedBuddyAllocator(void* memory,
+                                             std::size_t size,
+                                             LevelLookup lookup,
+                                             MemoryContents contents) :
+        allocator(memory, size, lookup, contents),
+        owner(std::this_thread::get_id()),
+        remote_frees(nullptr)
+    {
+    }
+
+
+    OwnedBuddyAllocator::OwnedBuddyAllocator(OwnedBuddyAllocator&& source) :
+        OwnedBuddyAllocator{}
+    {
+        swap_contents_with(source);
+    }
+
+
+    OwnedBuddyAllocator&
+    OwnedBuddyAllocator::operator=(OwnedBuddyAllocator&& rhs)
+    {
+        if (this != &rhs)
+        {
+            auto copy = std::move(rhs);
+            swap_contents_with(copy);
+        }
+
+        return *this;
+    }
+
+
+    void OwnedBuddyAllocator::swap_contents_with(OwnedBuddyAllocator& other)
+    {
+        std::swap(this->allocator, other.allocator);
+        other.owner.store(this->owner.exchange(other.owner.load()));
+        other.remote_frees.store(
+            this->remote_frees.exchange(other.remote_frees.load())
+        );
+    }
+
+
+    void* OwnedBuddyAllocator::allocate(std::size_t size)
+    {
+        assert(is_owned_by_current_thread());
+
+        // Blocks freed by other threads since the last allocation are
+        // returned to the tree first, so that they can be reused.
+        if (has_remote_frees())
+        {
+            drain_remote_frees();
+        }
+
+        return allocator.allocate(size);
+    }
+
+
+    void OwnedBuddyAllocator::deallocate(void* block)
+    {
+        if (manages_memory() && block != nullptr)
+        {
+            if (is_owned_by_current_thread())
+            {
+                allocator.deallocate(block);
+            }
+            else
+            {
+                push_remote_free(block, 0);
+            }
+        }
+    }
+
+
+    void OwnedBuddyAllocator::deallocate(void* block, std::size_t size)
+    {
+        if (manages_memory() && block != nullptr)
+        {
+            if (is_owned_by_current_thread())
+            {
+                allocator.deallocate(block, size);
+            }
+            else
+            {
+                assert(size != 0);
+                push_remote_free(block, size);
+            }
+        }
+    }
+
+
+    void OwnedBuddyAllocator::push_remote_free(void* block, std::size_t size)
+    {
+        // The freed block holds its own entry in the list, just like the
+        // blocks of a FreeList. Entries are only ever pushed, the owner
+        // takes the whole list at once, so the push can't suffer from
+        // ABA.
+        static_assert(sizeof(RemoteFree) <= BuddyAllocator::LEAF_SIZE,
+                      "An entry must fit in the smallest block!");
+        const auto entry = new (block) RemoteFree{ nullptr, size };
+        auto head = remote_frees.load(std::memory_order_relaxed);
+
+        do
+        {
+            entry->next = head;
+        } while (!remote_frees.compare_exchange_weak(
+                     head,
+                     entry,
+                     std::memory_order_release,
+                     std::memory_order_relaxed));
+    }
+
+
+    std::size_t OwnedBuddyAllocator::drain_remote_frees()
+    {
+        assert(is_owned_by_current_thread());
+        auto entry = remote_frees.exchange(nullptr, std::memory_order_acquire);
+        auto count = std::size_t(0);
+        void* batch[DRAIN_BATCH_SIZE];
+        auto batch_size = std::size_t(0);
+
+        // The entries are freed in batches, which are sorted by address
+        // so that buddies freed together are merged in a single pass.
+        // An entry's next pointer is read before the batch holding it is
+        // freed, as freeing writes over the blocks.
+        while (entry != nullptr)
+        {
+            const auto next = entry->next;
+            batch[batch_size++] = to_batch_entry(entry);
+
+            if (batch_size == DRAIN_BATCH_SIZE || next == nullptr)
+            {
+                LevelLocks no_locks;
+                allocator.free_batch(batch, batch_size, no_locks);
+                batch_size = 0;
+            }
+
+            entry = next;
+            ++count;
+        }
+
+        return count;
+    }
+
+
+    void* OwnedBuddyAllocator::to_batch_entry(RemoteFree* entry) const
+    {
+        LevelLocks no_locks;
+        const auto level = entry->size != 0 ?
+            std::size_t(allocator.level_for_block_with(entry->size)) :
+            allocator.level_of(entry, no_locks);
+
+        return allocator.to_batch_entry(entry, level);
+    }
+
+
+    void OwnedBuddyAllocator::take_ownership()
+    {
+        // Remote threads read the owner to choose between freeing
+        // directly and queueing the block. The release pairs with their
+        // acquire, so a thread which sees the new owner also sees the
+        // tree as the previous owner left it.
+        owner.store(std::this_thread::get_id(), std::memory_order_release);
+    }
+
+}
@@ -0,0 +1,71 @@
+#ifndef __OWNED_BUDDY_ALLOCATOR_HEADER_INCLUDED__
+#define __OWNED_BUDDY_ALLOCATOR_HEADER_INCLUDED__
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+
+#include "buddyallocator.hpp"
+
+
+namespace allocator
+{
+    class OwnedBuddyAllocator
+    {
+    public:
+        OwnedBuddyAllocator();
+        OwnedBuddyAllocator(
+            void* memory,
+            std::size_t size,
+            LevelLookup lookup = LevelLookup::split_map,
+            MemoryContents contents = MemoryContents::unknown
+        );
+        OwnedBuddyAllocator(OwnedBuddyAllocator&& source);
+        OwnedBuddyAllocator& operator=(OwnedBuddyAllocator&& rhs);
+
+        void* allocate(std::size_t size);
+        void deallocate(void* block);
+        void deallocate(void* block, std::size_t size);
+        std::size_t drain_remote_frees();
+        void take_ownership();
+
+        bool manages_memory() const
+        {
+            return allocator.manages_memory();
+        }
+
+        bool is_owned_by_current_thread() const
+        {
+            return owner.load(std::memory_order_acquire) ==
+                   std::this_thread::get_id();
+        }
+
+        bool has_remote_frees() const
+        {
+            return remote_frees.load(std::memory_order_relaxed) != nullptr;
+        }
+
+    private:
+        struct RemoteFree
+        {
+            RemoteFree* next;
+            std::size_t size;
+        };
+
+    private:
+        static const std::size_t DRAIN_BATCH_SIZE = 64;
+
+    private:
+        void swap_contents_with(OwnedBuddyAllocator& other);
+        void push_remote_free(void* block, std::size_t size);
+        void* to_batch_entry(RemoteFree* entry) const;
+
+    private:
+        BuddyAllocator allocator;
+        std::atomic<std::thread::id> owner;
+        std::atomic<RemoteFree*> remote_frees;
+    };
+
+}
+
+#endif // __OWNED_BUDDY_ALLOCATOR_HEADER_INCLUDED__
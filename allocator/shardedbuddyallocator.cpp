@@ -0,0 +1,197 @@
+#include "shardedbuddyallocator.hpp"
+
+#include <assert.h>
+#include <atomic>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+
+
+namespace allocator
+{
+    namespace
+    {
+        std::size_t thread_number()
+        {
+            // Threads are numbered in the order they first allocate, so
+            // consecutive threads start in different shards.
+            static std::atomic<std::size_t> threads_count{ 0 };
+            thread_local const auto number =
+                threads_count.fetch_add(1, std::memory_order_relaxed);
+
+            return number;
+        }
+    }
+
+
+    ShardedBuddyAllocator::ShardedBuddyAllocator() :
+        base(nullptr),
+        shard_size(0),
+        shards_count(0)
+    {
+    }
+
+
+    ShardedBuddyAllocator::ShardedBuddyAllocator(void* memory,
+                                                 std::size_t size,
+                                                 std::size_t shards_count,
+                                                 LevelLookup lookup) :
+        ShardedBuddyAllocator{}
+    {
+        if (memory == nullptr)
+        {
+            throw std::invalid_argument{ "Expected a pointer to memory!" };
+        }
+
+        const auto shard_size = shard_size_for(size, shards_count);
+        auto shards = std::unique_ptr<Shard[]>(new Shard[shards_count]);
+        const auto base = static_cast<char*>(memory);
+
+        for (auto i = std::size_t(0); i < shards_count; ++i)
+        {
+            shards[i].allocator =
+                BuddyAllocator(base + i * shard_size, shard_size, lookup);
+        }
+
+        this->base = base;
+        this->shard_size = shard_size;
+        this->shards_count = shards_count;
+        this->shards = std::move(shards);
+    }
+
+
+    std::size_t
+    ShardedBuddyAllocator::shard_size_for(std::size_t size,
+                                          std::size_t shards_count)
+    {
+        if (shards_count == 0)
+        {
+            throw std::invalid_argument{ "Expected a positive shard count!" };
+        }
+
+        // Shards start equally aligned, so they get trees of the same
+        // shape. Bytes left over after the last shard are not used.
+        const auto alignment = alignof(std::max_align_t);
+
+        return (size / shards_count) & ~(alignment - 1);
+    }
+
+
+    ShardedBuddyAllocator::ShardedBuddyAllocator(
+        ShardedBuddyAllocator&& source
+    ) :
+        ShardedBuddyAllocator{}
+    {
+        swap_contents_with(source);
+    }
+
+
+    ShardedBuddyAllocator&
+    ShardedBuddyAllocator::operator=(ShardedBuddyAllocator&& rhs)
+    {
+        if (this != &rhs)
+        {
+            auto copy = std::move(rhs);
+            swap_contents_with(copy);
+        }
+
+        return *this;
+    }
+
+
+    void ShardedBuddyAllocator::swap_contents_with(
+        ShardedBuddyAllocator& other
+    )
+    {
+        std::swap(this->base, other.base);
+        std::swap(this->shard_size, other.shard_size);
+        std::swap(this->shards_count, other.shards_count);
+        std::swap(this->shards, other.shards);
+    }
+
+
+    void* ShardedBuddyAllocator::allocate(std::size_t size)
+    {
+        if (!manages_memory() || size == 0)
+        {
+            return nullptr;
+        }
+
+        // The calling thread's shard is tried first. When it runs dry the
+        // block is stolen from the next shard which has one.
+        const auto home = home_shard();
+
+        for (auto i = std::size_t(0); i < shards_count; ++i)
+        {
+            const auto block =
+                allocate_from(shards[(home + i) % shards_count], size);
+
+            if (block != nullptr)
+            {
+                return block;
+            }
+        }
+
+        return nullptr;
+    }
+
+
+    void* ShardedBuddyAllocator::allocate_from(Shard& shard,
+                                               std::size_t size)
+    {
+        std::lock_guard<std::mutex> guard{ shard.lock };
+
+        return shard.allocator.allocate(size);
+    }
+
+
+    void ShardedBuddyAllocator::deallocate(void* block)
+    {
+        if (manages_memory() && block != nullptr)
+        {
+            auto& shard = shards[shard_of(block)];
+            std::lock_guard<std::mutex> guard{ shard.lock };
+            shard.allocator.deallocate(block);
+        }
+    }
+
+
+    void ShardedBuddyAllocator::deallocate(void* block, std::size_t size)
+    {
+        if (manages_memory() && block != nullptr)
+        {
+            auto& shard = shards[shard_of(block)];
+            std::lock_guard<std::mutex> guard{ shard.lock };
+            shard.allocator.deallocate(block, size);
+        }
+    }
+
+
+    bool ShardedBuddyAllocator::owns(const void* block) const
+    {
+        const auto address = reinterpret_cast<std::uintptr_t>(block);
+        const auto start = reinterpret_cast<std::uintptr_t>(base);
+
+        return manages_memory() &&
+               start <= address &&
+               address - start < shard_size * shards_count;
+    }
+
+
+    std::size_t ShardedBuddyAllocator::shard_of(const void* block) const
+    {
+        assert(owns(block));
+
+        return std::size_t(static_cast<const char*>(block) - base) /
+               shard_size;
+    }
+
+
+    std::size_t ShardedBuddyAllocator::home_shard() const
+    {
+        assert(manages_memory());
+
+        return thread_number() % shards_count;
+    }
+
+}
@@ -0,0 +1,79 @@
+#ifndef __SHARDED_BUDDY_ALLOCATOR_HEADER_INCLUDED__
+#define __SHARDED_BUDDY_ALLOCATOR_HEADER_INCLUDED__
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+
+#include "buddyallocator.hpp"
+
+
+namespace allocator
+{
+    class ShardedBuddyAllocator
+    {
+    public:
+        ShardedBuddyAllocator();
+        ShardedBuddyAllocator(
+            void* memory,
+            std::size_t size,
+            std::size_t shards_count,
+            LevelLookup lookup = LevelLookup::split_map
+        );
+        ShardedBuddyAllocator(ShardedBuddyAllocator&& source);
+        ShardedBuddyAllocator& operator=(ShardedBuddyAllocator&& rhs);
+
+        void* allocate(std::size_t size);
+        void deallocate(void* block);
+        void deallocate(void* block, std::size_t size);
+        bool owns(const void* block) const;
+        std::size_t shard_of(const void* block) const;
+        std::size_t home_shard() const;
+
+        bool manages_memory() const
+        {
+            return shards != nullptr;
+        }
+
+        std::size_t get_shards_count() const
+        {
+            return shards_count;
+        }
+
+        std::size_t get_shard_size() const
+        {
+            return shard_size;
+        }
+
+    private:
+        static const std::size_t CACHE_LINE_SIZE = 64;
+
+        // A cache line's worth of padding follows each shard, so that no
+        // two shards share a line whatever the alignment of the array is.
+        // Over-aligned types can't be used as C++14's new doesn't
+        // honour their alignment.
+        struct Shard
+        {
+            std::mutex lock;
+            BuddyAllocator allocator;
+            char padding[CACHE_LINE_SIZE];
+        };
+
+    private:
+        static std::size_t shard_size_for(std::size_t size,
+                                          std::size_t shards_count);
+
+    private:
+        void swap_contents_with(ShardedBuddyAllocator& other);
+        void* allocate_from(Shard& shard, std::size_t size);
+
+    private:
+        char* base;
+        std::size_t shard_size;
+        std::size_t shards_count;
+        std::unique_ptr<Shard[]> shards;
+    };
+
+}
+
+#endif // __SHARDED_BUDDY_ALLOCATOR_HEADER_INCLUDED__
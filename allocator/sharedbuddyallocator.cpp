@@ -0,0 +1,297 @@
+#include "sharedbuddyallocator.hpp"
+
+#if defined(__SHARED_BUDDY_ALLOCATOR_AVAILABLE__)
+
+#include <assert.h>
+#include <cerrno>
+#include <cstdint>
+#include <pthread.h>
+#include <stdexcept>
+#include <utility>
+
+// macOS has no robust mutexes.
+#if !defined(__APPLE__)
+#define __ROBUST_MUTEXES_AVAILABLE__
+#endif
+
+
+namespace allocator
+{
+    namespace
+    {
+        const std::uint64_t SEGMENT_MAGIC = 0x5348415245444255;
+
+
+        std::size_t round_up(std::size_t value, std::size_t alignment)
+        {
+            const auto remainder = value % alignment;
+
+            return remainder != 0 ? value + (alignment - remainder) : value;
+        }
+    }
+
+
+    // Lives at the start of the segment. Everything after it is located
+    // by offsets, so the segment may be mapped at a different address in
+    // each process.
+    struct SharedBuddyAllocator::Header
+    {
+        std::uint64_t magic;
+        std::size_t segment_size;
+        std::size_t metadata_offset;
+        std::size_t arena_offset;
+        LevelLookup lookup;
+        std::size_t non_empty_levels;
+        pthread_mutex_t mutex;
+    };
+
+
+    class SharedBuddyAllocator::SegmentLock
+    {
+    public:
+        explicit SegmentLock(Header& header) :
+            mutex(header.mutex)
+        {
+            const auto error = pthread_mutex_lock(&mutex);
+
+            if (error == EOWNERDEAD)
+            {
+                // A process died in the middle of an operation and may
+                // have left the tree half-updated. The mutex is released
+                // without being made consistent, which makes it
+                // unrecoverable, so that every view fails from now on
+                // instead of working with a broken tree.
+                pthread_mutex_unlock(&mutex);
+            }
+
+            if (error != 0)
+            {
+                throw std::runtime_error{
+                    "A process died while holding the segment's lock!"
+                };
+            }
+        }
+
+        SegmentLock(const SegmentLock&) = delete;
+        SegmentLock& operator=(const SegmentLock&) = delete;
+
+        ~SegmentLock()
+        {
+            pthread_mutex_unlock(&mutex);
+        }
+
+    private:
+        pthread_mutex_t& mutex;
+    };
+
+
+    SharedBuddyAllocator::SharedBuddyAllocator() :
+        header(nullptr)
+    {
+    }
+
+
+    SharedBuddyAllocator::SharedBuddyAllocator(void* segment,
+                                               std::size_t segment_size,
+                                               LevelLookup lookup,
+                                               MemoryContents contents) :
+        SharedBuddyAllocator{}
+    {
+        const auto header = header_of(segment);
+        const auto metadata_offset =
+            round_up(sizeof(Header), alignof(std::max_align_t));
+        // The metadata is sized for the whole segment, which is an upper
+        // bound for the arena that follows it.
+        const auto metadata_size =
+            BuddyAllocator::required_metadata_size(segment_size, lookup);
+        const auto arena_offset = round_up(metadata_offset + metadata_size,
+                                           BuddyAllocator::LEAF_SIZE);
+
+        if (segment_size <= arena_offset)
+        {
+            throw std::invalid_argument{ "The segment is too small!" };
+        }
+
+        const auto base = static_cast<unsigned char*>(segment);
+        allocator = BuddyAllocator(base + arena_offset,
+                                   segment_size - arena_offset,
+                                   base + metadata_offset,
+                                   metadata_size,
+                                   lookup,
+                                   contents);
+
+        auto attributes = pthread_mutexattr_t{};
+        pthread_mutexattr_init(&attributes);
+        pthread_mutexattr_setpshared(&attributes, PTHREAD_PROCESS_SHARED);
+#if defined(__ROBUST_MUTEXES_AVAILABLE__)
+        pthread_mutexattr_setrobust(&attributes, PTHREAD_MUTEX_ROBUST);
+#endif
+        const auto error = pthread_mutex_init(&header->mutex, &attributes);
+        pthread_mutexattr_destroy(&attributes);
+
+        if (error != 0)
+        {
+            throw std::invalid_argument{
+                "Could not create a process-shared lock!"
+            };
+        }
+
+        header->segment_size = segment_size;
+        header->metadata_offset = metadata_offset;
+        header->arena_offset = arena_offset;
+        header->lookup = lookup;
+        header->non_empty_levels = allocator.non_empty_levels.load();
+        // Written last so that a half-formatted segment is never taken
+        // for a valid one.
+        header->magic = SEGMENT_MAGIC;
+        this->header = header;
+    }
+
+
+    SharedBuddyAllocator::SharedBuddyAllocator(void* segment) :
+        SharedBuddyAllocator{}
+    {
+        const auto header = header_of(segment);
+
+        if (header->magic != SEGMENT_MAGIC)
+        {
+            throw std::invalid_argument{
+                "The segment holds no shared allocator!"
+            };
+        }
+
+        this->header = header;
+        attach_allocator();
+    }
+
+
+    SharedBuddyAllocator::Header*
+    SharedBuddyAllocator::header_of(void* segment)
+    {
+        // Block alignment is computed from addresses, so the views of all
+        // processes agree only if each mapping is equally aligned.
+        if (segment == nullptr ||
+            reinterpret_cast<std::uintptr_t>(segment) %
+                BuddyAllocator::ALIGNMENT_REQUIREMENT != 0)
+        {
+            throw std::invalid_argument{ "Expected an aligned segment!" };
+        }
+
+        return static_cast<Header*>(segment);
+    }
+
+
+    void SharedBuddyAllocator::attach_allocator()
+    {
+        const auto base = reinterpret_cast<unsigned char*>(header);
+        allocator.attach(base + header->arena_offset,
+                         header->segment_size - header->arena_offset,
+                         base + header->metadata_offset,
+                         header->lookup);
+    }
+
+
+    SharedBuddyAllocator::SharedBuddyAllocator(SharedBuddyAllocator&& source) :
+        SharedBuddyAllocator{}
+    {
+        swap_contents_with(source);
+    }
+
+
+    SharedBuddyAllocator&
+    SharedBuddyAllocator::operator=(SharedBuddyAllocator&& rhs)
+    {
+        if (this != &rhs)
+        {
+            auto copy = std::move(rhs);
+            swap_contents_with(copy);
+        }
+
+        return *this;
+    }
+
+
+    void SharedBuddyAllocator::swap_contents_with(SharedBuddyAllocator& other)
+    {
+        std::swap(this->header, other.header);
+        this->allocator.swap_contents_with(other.allocator);
+    }
+
+
+    template <class Operation>
+    void SharedBuddyAllocator::with_shared_state(Operation operation)
+    {
+        // The tree lives in the segment, only the mask of non-empty
+        // levels is cached in the view, so it is refreshed from the
+        // segment before the operation and published after it.
+        SegmentLock lock{ *header };
+        allocator.non_empty_levels.store(header->non_empty_levels,
+                                         std::memory_order_relaxed);
+        operation();
+        header->non_empty_levels =
+            allocator.non_empty_levels.load(std::memory_order_relaxed);
+    }
+
+
+    void* SharedBuddyAllocator::allocate(std::size_t size)
+    {
+        auto block = static_cast<void*>(nullptr);
+
+        if (manages_memory() && size != 0)
+        {
+            with_shared_state([this, size, &block]()
+            {
+                block = allocator.allocate(size);
+            });
+        }
+
+        return block;
+    }
+
+
+    void SharedBuddyAllocator::deallocate(void* block)
+    {
+        if (manages_memory() && block != nullptr)
+        {
+            with_shared_state([this, block]()
+            {
+                allocator.deallocate(block);
+            });
+        }
+    }
+
+
+    void SharedBuddyAllocator::deallocate(void* block, std::size_t size)
+    {
+        if (manages_memory() && block != nullptr)
+        {
+            with_shared_state([this, block, size]()
+            {
+                allocator.deallocate(block, size);
+            });
+        }
+    }
+
+
+    std::size_t SharedBuddyAllocator::offset_of(const void* block) const
+    {
+        assert(manages_memory());
+        const auto address = reinterpret_cast<std::uintptr_t>(block);
+        const auto base = reinterpret_cast<std::uintptr_t>(header);
+        assert(base < address && address < base + header->segment_size);
+
+        return address - base;
+    }
+
+
+    void* SharedBuddyAllocator::block_at(std::size_t offset) const
+    {
+        assert(manages_memory());
+        assert(0 < offset && offset < header->segment_size);
+
+        return reinterpret_cast<unsigned char*>(header) + offset;
+    }
+
+}
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef __SHARED_BUDDY_ALLOCATOR_HEADER_INCLUDED__
+#define __SHARED_BUDDY_ALLOCATOR_HEADER_INCLUDED__
+
+#include "virtualmemory.hpp"
+
+#if defined(__VIRTUAL_MEMORY_AVAILABLE__)
+#define __SHARED_BUDDY_ALLOCATOR_AVAILABLE__
+
+#include <cstddef>
+
+#include "buddyallocator.hpp"
+
+
+namespace allocator
+{
+    class SharedBuddyAllocator
+    {
+    public:
+        SharedBuddyAllocator();
+        SharedBuddyAllocator(
+            void* segment,
+            std::size_t segment_size,
+            LevelLookup lookup = LevelLookup::split_map,
+            MemoryContents contents = MemoryContents::unknown
+        );
+        explicit SharedBuddyAllocator(void* segment);
+        SharedBuddyAllocator(SharedBuddyAllocator&& source);
+        SharedBuddyAllocator& operator=(SharedBuddyAllocator&& rhs);
+
+        void* allocate(std::size_t size);
+        void deallocate(void* block);
+        void deallocate(void* block, std::size_t size);
+        std::size_t offset_of(const void* block) const;
+        void* block_at(std::size_t offset) const;
+
+        bool manages_memory() const
+        {
+            return header != nullptr;
+        }
+
+    private:
+        struct Header;
+        class SegmentLock;
+
+    private:
+        static Header* header_of(void* segment);
+
+    private:
+        void swap_contents_with(SharedBuddyAllocator& other);
+        void attach_allocator();
+        template <class Operation>
+        void with_shared_state(Operation operation);
+
+    private:
+        Header* header;
+        BuddyAllocator allocator;
+    };
+
+}
+
+#endif
+
+#endif // __SHARED_BUDDY_ALLOCATOR_HEADER_INCLUDED__
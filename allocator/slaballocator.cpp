@@ -0,0 +1,271 @@
+#include "slaballocator.hpp"
+
+#include <assert.h>
+#include <cstdint>
+#include <initializer_list>
+#include <new>
+#include <utility>
+
+
+namespace allocator
+{
+    SlabAllocator::SlabAllocator() :
+        allocator(nullptr),
+        slabs_count(0),
+        size_classes()
+    {
+    }
+
+
+    SlabAllocator::SlabAllocator(BuddyAllocator& allocator) :
+        SlabAllocator{}
+    {
+        this->allocator = &allocator;
+    }
+
+
+    SlabAllocator::SlabAllocator(SlabAllocator&& source) :
+        SlabAllocator{}
+    {
+        swap_contents_with(source);
+    }
+
+
+    SlabAllocator& SlabAllocator::operator=(SlabAllocator&& rhs)
+    {
+        if (this != &rhs)
+        {
+            auto copy = std::move(rhs);
+            swap_contents_with(copy);
+        }
+
+        return *this;
+    }
+
+
+    void SlabAllocator::swap_contents_with(SlabAllocator& other)
+    {
+        std::swap(this->allocator, other.allocator);
+        std::swap(this->slabs_count, other.slabs_count);
+        std::swap(this->size_classes, other.size_classes);
+    }
+
+
+    SlabAllocator::~SlabAllocator()
+    {
+        release_all_slabs();
+    }
+
+
+    void SlabAllocator::release_all_slabs()
+    {
+        for (auto& size_class : size_classes)
+        {
+            for (auto list : { &size_class.partial, &size_class.full })
+            {
+                while (*list != nullptr)
+                {
+                    const auto slab = *list;
+                    unlink(*list, slab);
+                    release(slab);
+                }
+            }
+        }
+    }
+
+
+    void* SlabAllocator::allocate(std::size_t size)
+    {
+        if (!is_attached() || size == 0)
+        {
+            return nullptr;
+        }
+
+        if (size > MAX_OBJECT_SIZE)
+        {
+            return allocator->allocate(size);
+        }
+
+        auto& size_class = size_classes[size_class_of(size)];
+        auto slab = size_class.partial;
+
+        if (slab == nullptr)
+        {
+            slab = create_slab((size_class_of(size) + 1) * MIN_OBJECT_SIZE);
+
+            if (slab == nullptr)
+            {
+                return nullptr;
+            }
+
+            link(size_class.partial, slab);
+        }
+
+        const auto index = slab->free_objects.find_first_set();
+        assert(index < slab->objects_count);
+        slab->free_objects.flip(index);
+
+        if (++slab->used_count == slab->objects_count)
+        {
+            unlink(size_class.partial, slab);
+            link(size_class.full, slab);
+        }
+
+        return reinterpret_cast<char*>(slab) +
+               OBJECTS_OFFSET +
+               index * slab->object_size;
+    }
+
+
+    SlabAllocator::Slab* SlabAllocator::create_slab(std::size_t object_size)
+    {
+        const auto memory = allocator->allocate(SLAB_SIZE);
+
+        if (memory == nullptr)
+        {
+            return nullptr;
+        }
+
+        const auto slab = static_cast<Slab*>(memory);
+        const auto objects_count = (SLAB_SIZE - OBJECTS_OFFSET) / object_size;
+        slab->previous = nullptr;
+        slab->next = nullptr;
+        slab->object_size = object_size;
+        slab->objects_count = objects_count;
+        slab->used_count = 0;
+        new (&slab->free_objects) BitMap(
+            reinterpret_cast<unsigned char*>(slab + 1),
+            objects_count,
+            true
+        );
+        ++slabs_count;
+
+        return slab;
+    }
+
+
+    void SlabAllocator::deallocate(void* block, std::size_t size)
+    {
+        if (!is_attached() || block == nullptr)
+        {
+            return;
+        }
+
+        if (size > MAX_OBJECT_SIZE)
+        {
+            allocator->deallocate(block, size);
+
+            return;
+        }
+
+        const auto slab = slab_of(block);
+        auto& size_class = size_classes[size_class_of(size)];
+        assert(size_class_of(slab->object_size) == size_class_of(size));
+        const auto offset = static_cast<char*>(block) -
+                            reinterpret_cast<char*>(slab) -
+                            OBJECTS_OFFSET;
+        const auto index = std::size_t(offset) / slab->object_size;
+        assert(!slab->free_objects.at(index));
+        slab->free_objects.flip(index);
+
+        if (slab->used_count-- == slab->objects_count)
+        {
+            unlink(size_class.full, slab);
+            link(size_class.partial, slab);
+        }
+
+        // One empty slab is kept per size class, so that a class whose
+        // last object is freed and allocated again in turn doesn't pass
+        // a slab to and from the buddy allocator each time.
+        if (slab->used_count == 0 &&
+            (size_class.partial != slab || slab->next != nullptr))
+        {
+            unlink(size_class.partial, slab);
+            release(slab);
+        }
+    }
+
+
+    SlabAllocator::Slab* SlabAllocator::slab_of(void* object) const
+    {
+        // A slab is a buddy block, which lies at a multiple of its size
+        // from the buddy allocator's logical start, whatever the
+        // alignment of its memory. The slab of an object is thus found by
+        // masking the object's offset from that start.
+        const auto start = std::uintptr_t(allocator->start);
+        const auto offset = reinterpret_cast<std::uintptr_t>(object) - start;
+
+        return reinterpret_cast<Slab*>(
+            start + (offset & ~std::uintptr_t(SLAB_SIZE - 1))
+        );
+    }
+
+
+    std::size_t SlabAllocator::release_empty_slabs()
+    {
+        auto count = std::size_t(0);
+
+        for (auto& size_class : size_classes)
+        {
+            auto slab = size_class.partial;
+
+            while (slab != nullptr)
+            {
+                const auto next = slab->next;
+
+                if (slab->used_count == 0)
+                {
+                    unlink(size_class.partial, slab);
+                    release(slab);
+                    ++count;
+                }
+
+                slab = next;
+            }
+        }
+
+        return count;
+    }
+
+
+    void SlabAllocator::release(Slab* slab)
+    {
+        slab->free_objects.~BitMap();
+        allocator->deallocate(slab, SLAB_SIZE);
+        --slabs_count;
+    }
+
+
+    void SlabAllocator::link(Slab*& list, Slab* slab)
+    {
+        slab->previous = nullptr;
+        slab->next = list;
+
+        if (list != nullptr)
+        {
+            list->previous = slab;
+        }
+
+        list = slab;
+    }
+
+
+    void SlabAllocator::unlink(Slab*& list, Slab* slab)
+    {
+        if (slab->previous != nullptr)
+        {
+            slab->previous->next = slab->next;
+        }
+        else
+        {
+            assert(list == slab);
+            list = slab->next;
+        }
+
+        if (slab->next != nullptr)
+        {
+            slab->next->previous = slab->previous;
+        }
+    }
+
+}
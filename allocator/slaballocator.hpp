@@ -0,0 +1,89 @@
+#ifndef __SLAB_ALLOCATOR_HEADER_INCLUDED__
+#define __SLAB_ALLOCATOR_HEADER_INCLUDED__
+
+#include <cstddef>
+
+#include "bitmap.hpp"
+#include "buddyallocator.hpp"
+
+
+namespace allocator
+{
+    class SlabAllocator
+    {
+        struct Slab
+        {
+            Slab* previous;
+            Slab* next;
+            std::size_t object_size;
+            std::size_t objects_count;
+            std::size_t used_count;
+            BitMap free_objects;
+        };
+
+        struct SizeClass
+        {
+            Slab* partial;
+            Slab* full;
+        };
+
+    public:
+        static const std::size_t SLAB_SIZE = 4096;
+        static const std::size_t MIN_OBJECT_SIZE = 8;
+        static const std::size_t MAX_OBJECT_SIZE = 128;
+        static const std::size_t SIZE_CLASSES_COUNT =
+            MAX_OBJECT_SIZE / MIN_OBJECT_SIZE;
+
+    public:
+        SlabAllocator();
+        explicit SlabAllocator(BuddyAllocator& allocator);
+        SlabAllocator(SlabAllocator&& source);
+        SlabAllocator& operator=(SlabAllocator&& rhs);
+        ~SlabAllocator();
+
+        void* allocate(std::size_t size);
+        void deallocate(void* block, std::size_t size);
+        std::size_t release_empty_slabs();
+
+        bool is_attached() const
+        {
+            return allocator != nullptr;
+        }
+
+        std::size_t get_slabs_count() const
+        {
+            return slabs_count;
+        }
+
+    private:
+        static const std::size_t OBJECTS_OFFSET = 128;
+
+        static_assert(sizeof(Slab) +
+                      BitMap::storage_size_for(SLAB_SIZE / MIN_OBJECT_SIZE) <=
+                      OBJECTS_OFFSET,
+                      "The slab header must fit before the objects!");
+
+        static std::size_t size_class_of(std::size_t size)
+        {
+            return (size - 1) / MIN_OBJECT_SIZE;
+        }
+
+        static void link(Slab*& list, Slab* slab);
+        static void unlink(Slab*& list, Slab* slab);
+
+    private:
+        Slab* create_slab(std::size_t object_size);
+        Slab* slab_of(void* object) const;
+        void release(Slab* slab);
+        void release_all_slabs();
+        void swap_contents_with(SlabAllocator& other);
+
+    private:
+        BuddyAllocator* allocator;
+        std::size_t slabs_count;
+        SizeClass size_classes[SIZE_CLASSES_COUNT];
+    };
+
+}
+
+#endif // __SLAB_ALLOCATOR_HEADER_INCLUDED__
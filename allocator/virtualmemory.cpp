@@ -0,0 +1,238 @@
+#include "virtualmemory.hpp"
+
+#if defined(__VIRTUAL_MEMORY_AVAILABLE__)
+
+#include <assert.h>
+#include <climits>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <vector>
+
+#if defined(__linux__)
+#include <sys/syscall.h>
+#endif
+
+#include "arithmetic.hpp"
+
+
+namespace allocator
+{
+    std::size_t page_size()
+    {
+        static const auto result = std::size_t(sysconf(_SC_PAGESIZE));
+
+        return result;
+    }
+
+
+    void* reserve_address_space(std::size_t size, std::size_t alignment)
+    {
+        assert(size > 0 && size % page_size() == 0);
+        assert(is_power_of_two(alignment));
+        alignment = alignment > page_size() ? alignment : page_size();
+        const auto padded_size = size + (alignment - page_size());
+        auto flags = MAP_PRIVATE | MAP_ANONYMOUS;
+#if defined(MAP_NORESERVE)
+        flags |= MAP_NORESERVE;
+#endif
+        const auto memory =
+            mmap(nullptr, padded_size, PROT_NONE, flags, -1, 0);
+
+        if (memory == MAP_FAILED)
+        {
+            return nullptr;
+        }
+
+        // mmap only guarantees page alignment, so the padding before and
+        // after the aligned range is given back.
+        const auto start = reinterpret_cast<std::uintptr_t>(memory);
+        const auto aligned_start =
+            (start + (alignment - 1)) & ~std::uintptr_t(alignment - 1);
+        const auto head = aligned_start - start;
+        const auto tail = padded_size - size - head;
+
+        if (head != 0)
+        {
+            munmap(memory, head);
+        }
+
+        if (tail != 0)
+        {
+            munmap(reinterpret_cast<void*>(aligned_start + size), tail);
+        }
+
+        return reinterpret_cast<void*>(aligned_start);
+    }
+
+
+    void release_address_space(void* memory, std::size_t size)
+    {
+        munmap(memory, size);
+    }
+
+
+    bool commit(void* memory, std::size_t size)
+    {
+        return mprotect(memory, size, PROT_READ | PROT_WRITE) == 0;
+    }
+
+
+    void decommit(void* memory, std::size_t size)
+    {
+        // Private anonymous pages read as zeros once they are dropped, so
+        // committing them again yields zero-filled memory.
+        madvise(memory, size, MADV_DONTNEED);
+        mprotect(memory, size, PROT_NONE);
+    }
+
+
+    std::size_t purge_pages_within(void* memory, std::size_t size)
+    {
+        // Only whole pages lying within the range can be dropped without
+        // losing bytes next to it.
+        const auto mask = std::uintptr_t(page_size() - 1);
+        const auto start = reinterpret_cast<std::uintptr_t>(memory);
+        const auto first_page = (start + mask) & ~mask;
+        const auto end = (start + size) & ~mask;
+
+        if (first_page >= end)
+        {
+            return 0;
+        }
+
+        const auto purged_size = std::size_t(end - first_page);
+
+        return madvise(reinterpret_cast<void*>(first_page),
+                       purged_size,
+                       MADV_DONTNEED) == 0 ?
+               purged_size :
+               0;
+    }
+
+
+    Mapping map_huge_pages(std::size_t size, HugePages preferred)
+    {
+        assert(size > 0 && size % HUGE_PAGE_SIZE == 0);
+#if defined(MAP_HUGETLB)
+        // Explicit huge pages come from a pool the administrator reserves,
+        // which is empty by default, so failing here is the common case.
+        if (preferred == HugePages::huge_tlb)
+        {
+            const auto memory =
+                mmap(nullptr,
+                     size,
+                     PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB,
+                     -1,
+                     0);
+
+            if (memory != MAP_FAILED)
+            {
+                return { memory, HugePages::huge_tlb };
+            }
+        }
+#endif
+        // Transparent huge pages can only back ranges aligned to a huge
+        // page.
+        const auto memory = reserve_address_space(size, HUGE_PAGE_SIZE);
+
+        if (memory == nullptr)
+        {
+            return { nullptr, HugePages::none };
+        }
+
+        if (!commit(memory, size))
+        {
+            release_address_space(memory, size);
+
+            return { nullptr, HugePages::none };
+        }
+#if defined(MADV_HUGEPAGE)
+        if (preferred != HugePages::none &&
+            madvise(memory, size, MADV_HUGEPAGE) == 0)
+        {
+            return { memory, HugePages::transparent };
+        }
+#endif
+        return { memory, HugePages::none };
+    }
+
+
+    std::size_t numa_nodes_count()
+    {
+        // The online nodes are listed in increasing order, as in "0-1" or
+        // "0,2-3", so the last number is the highest node.
+        static const auto result = []()
+        {
+            auto nodes = std::string{};
+            auto highest_node = std::size_t(0);
+#if defined(__linux__)
+            std::getline(std::ifstream{ "/sys/devices/system/node/online" },
+                         nodes);
+#endif
+            auto number = std::size_t(0);
+
+            for (const auto c : nodes)
+            {
+                if ('0' <= c && c <= '9')
+                {
+                    number = 10 * number + std::size_t(c - '0');
+                    highest_node = number;
+                }
+                else
+                {
+                    number = 0;
+                }
+            }
+
+            return highest_node + 1;
+        }();
+
+        return result;
+    }
+
+
+    std::size_t current_numa_node()
+    {
+#if defined(__linux__) && defined(SYS_getcpu)
+        auto cpu = 0u;
+        auto node = 0u;
+
+        if (syscall(SYS_getcpu, &cpu, &node, nullptr) == 0)
+        {
+            return node;
+        }
+#endif
+        return 0;
+    }
+
+
+    bool bind_to_numa_node(void* memory, std::size_t size, std::size_t node)
+    {
+#if defined(__linux__) && defined(SYS_mbind)
+        // The policy only applies to pages faulted in after the call, so
+        // it has to precede the first touch of the range.
+        const auto MPOL_BIND = 2;
+        const auto BITS_PER_WORD = CHAR_BIT * sizeof(unsigned long);
+        auto mask = std::vector<unsigned long>(node / BITS_PER_WORD + 1);
+        mask[node / BITS_PER_WORD] = 1ul << (node % BITS_PER_WORD);
+
+        // The kernel reads one bit less than the count it is given.
+        return syscall(SYS_mbind,
+                       memory,
+                       size,
+                       MPOL_BIND,
+                       mask.data(),
+                       mask.size() * BITS_PER_WORD + 1,
+                       0) == 0;
+#else
+        return false;
+#endif
+    }
+
+}
+
+#endif
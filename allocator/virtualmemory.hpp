@@ -0,0 +1,63 @@
+#ifndef __VIRTUAL_MEMORY_HEADER_INCLUDED__
+#define __VIRTUAL_MEMORY_HEADER_INCLUDED__
+
+#if defined(__unix__) || defined(__APPLE__)
+#define __VIRTUAL_MEMORY_AVAILABLE__
+
+#include <cstddef>
+
+
+namespace allocator
+{
+    constexpr std::size_t HUGE_PAGE_SIZE = std::size_t(1) << 21;
+
+
+    enum class HugePages
+    {
+        none,
+        transparent,
+        huge_tlb
+    };
+
+
+    struct Mapping
+    {
+        void* memory;
+        HugePages pages;
+    };
+
+
+    std::size_t page_size();
+
+
+    void* reserve_address_space(std::size_t size, std::size_t alignment);
+
+
+    void release_address_space(void* memory, std::size_t size);
+
+
+    bool commit(void* memory, std::size_t size);
+
+
+    void decommit(void* memory, std::size_t size);
+
+
+    std::size_t purge_pages_within(void* memory, std::size_t size);
+
+
+    Mapping map_huge_pages(std::size_t size, HugePages preferred);
+
+
+    std::size_t numa_nodes_count();
+
+
+    std::size_t current_numa_node();
+
+
+    bool bind_to_numa_node(void* memory, std::size_t size, std::size_t node);
+
+}
+
+#endif
+
+#endif // __VIRTUAL_MEMORY_HEADER_INCLUDED__
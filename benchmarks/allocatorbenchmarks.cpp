@@ -0,0 +1,274 @@
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#if defined(__unix__)
+#include <sys/mman.h>
+#endif
+
+#include "workloads.hpp"
+
+namespace alc = allocator;
+using namespace benchmarks;
+
+
+constexpr auto MAX_ARENA_SIZE = std::size_t(1) << 30;
+
+
+char* huge_memory()
+{
+    // Pages are only touched by the bookkeeping of the arena being built,
+    // so a gibibyte of address space is cheap to reserve once.
+    static const auto memory = std::unique_ptr<char[]>(
+        new char[MAX_ARENA_SIZE]
+    );
+
+    return memory.get();
+}
+
+
+#define REGISTER_WORKLOADS_FOR(Allocator)                                   \
+    BENCHMARK_TEMPLATE(single_size, Allocator)                              \
+        ->RangeMultiplier(4)->Range(MIN_BLOCK_SIZE, MAX_BLOCK_SIZE);        \
+    BENCHMARK_TEMPLATE(random_mix, Allocator)->Arg(64)->Arg(1024);          \
+    BENCHMARK_TEMPLATE(lifo_free, Allocator)                                \
+        ->Args({ 256, 16 })->Args({ 256, 512 });                            \
+    BENCHMARK_TEMPLATE(fifo_free, Allocator)                                \
+        ->Args({ 256, 16 })->Args({ 256, 512 });                            \
+    BENCHMARK_TEMPLATE(churn, Allocator)->Arg(1024)->Arg(8192)
+
+REGISTER_WORKLOADS_FOR(SizedBuddy);
+REGISTER_WORKLOADS_FOR(UnsizedBuddy);
+REGISTER_WORKLOADS_FOR(UnsizedBuddyWithLevelMap);
+#if defined(__GROWABLE_BUDDY_HEAP_AVAILABLE__)
+REGISTER_WORKLOADS_FOR(GrowableHeapAdaptor);
+#endif
+REGISTER_WORKLOADS_FOR(MallocAdaptor);
+#if defined(__BENCHMARK_PMR_RESOURCES__)
+REGISTER_WORKLOADS_FOR(PoolResourceAdaptor);
+REGISTER_WORKLOADS_FOR(MonotonicResourceAdaptor);
+#endif
+
+
+template <alc::LevelLookup Lookup>
+void construction(benchmark::State& state)
+{
+    const auto size = std::size_t(state.range(0));
+    const auto memory = huge_memory();
+
+    for (auto _ : state)
+    {
+        auto allocator = alc::BuddyAllocator(memory, size, Lookup);
+        benchmark::DoNotOptimize(allocator);
+    }
+
+    state.SetBytesProcessed(state.iterations() * size);
+}
+
+BENCHMARK_TEMPLATE(construction, alc::LevelLookup::split_map)
+    ->RangeMultiplier(8)->Range(std::size_t(1) << 12, MAX_ARENA_SIZE);
+BENCHMARK_TEMPLATE(construction, alc::LevelLookup::level_map)
+    ->RangeMultiplier(8)->Range(std::size_t(1) << 12, MAX_ARENA_SIZE);
+
+
+#if defined(__unix__)
+template <alc::MemoryContents Contents>
+void construction_over_fresh_pages(benchmark::State& state)
+{
+    // Each arena gets a new anonymous mapping, so the cost of faulting in
+    // the pages the bookkeeping writes to is part of the measurement.
+    const auto size = std::size_t(state.range(0));
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        const auto memory = mmap(nullptr,
+                                 size,
+                                 PROT_READ | PROT_WRITE,
+                                 MAP_PRIVATE | MAP_ANONYMOUS,
+                                 -1,
+                                 0);
+
+        if (memory == MAP_FAILED)
+        {
+            state.SkipWithError("mmap failed");
+            break;
+        }
+
+        state.ResumeTiming();
+
+        {
+            auto allocator = alc::BuddyAllocator(memory,
+                                                 size,
+                                                 alc::LevelLookup::split_map,
+                                                 Contents);
+            benchmark::DoNotOptimize(allocator);
+        }
+
+        state.PauseTiming();
+        munmap(memory, size);
+        state.ResumeTiming();
+    }
+
+    state.SetBytesProcessed(state.iterations() * size);
+}
+
+BENCHMARK_TEMPLATE(construction_over_fresh_pages, alc::MemoryContents::unknown)
+    ->RangeMultiplier(8)->Range(std::size_t(1) << 12, MAX_ARENA_SIZE);
+BENCHMARK_TEMPLATE(construction_over_fresh_pages,
+                   alc::MemoryContents::zero_filled)
+    ->RangeMultiplier(8)->Range(std::size_t(1) << 12, MAX_ARENA_SIZE);
+#endif
+
+
+#if defined(__GROWABLE_BUDDY_HEAP_AVAILABLE__)
+void grow_and_shrink(benchmark::State& state)
+{
+    // Fills a number of chunks and frees everything, so each iteration
+    // commits the chunks and releases all but the spare one.
+    constexpr auto CHUNK_SIZE = std::size_t(1) << 20;
+    constexpr auto SIZE = std::size_t(4096);
+    const auto chunks_count = std::size_t(state.range(0));
+    const auto count = chunks_count * (CHUNK_SIZE / 2 / SIZE);
+    auto heap = alc::GrowableBuddyHeap(CHUNK_SIZE, chunks_count);
+    auto blocks = std::vector<void*>(count);
+
+    for (auto _ : state)
+    {
+        for (auto& block : blocks)
+        {
+            block = heap.allocate(SIZE);
+        }
+
+        benchmark::ClobberMemory();
+
+        for (auto block : blocks)
+        {
+            heap.deallocate(block, SIZE);
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * count);
+}
+
+BENCHMARK(grow_and_shrink)->RangeMultiplier(4)->Range(1, 64);
+#endif
+
+
+void churn_with_purging(benchmark::State& state)
+{
+    // The churn workload with blocks of at least a given size purged when
+    // they are freed. 0 turns purging off.
+    constexpr auto LIVE_COUNT = std::size_t(1024);
+    const auto threshold = std::size_t(state.range(0));
+    auto memory = std::unique_ptr<char[]>(new char[ARENA_SIZE]);
+    auto allocator = alc::BuddyAllocatorWithStats(memory.get(), ARENA_SIZE);
+    allocator.set_purge_threshold(threshold);
+    const auto sizes = random_sizes(LIVE_COUNT * 16);
+    auto blocks = std::vector<void*>(LIVE_COUNT);
+    auto next_size = std::size_t(0);
+
+    for (auto& block : blocks)
+    {
+        block = allocator.allocate(sizes[next_size++]);
+    }
+
+    for (auto _ : state)
+    {
+        // Big blocks come and go every so often, so that purges happen.
+        const auto big_block = allocator.allocate(MAX_BLOCK_SIZE * 64);
+        benchmark::DoNotOptimize(big_block);
+        allocator.deallocate(big_block);
+        const auto victim = next_size % LIVE_COUNT;
+        allocator.deallocate(blocks[victim]);
+        blocks[victim] = allocator.allocate(sizes[next_size++ % sizes.size()]);
+    }
+
+    state.counters["purged_bytes_per_iteration"] = benchmark::Counter(
+        double(allocator.get_stats().get_purged_bytes()),
+        benchmark::Counter::kAvgIterations
+    );
+
+    for (auto block : blocks)
+    {
+        allocator.deallocate(block);
+    }
+}
+
+BENCHMARK(churn_with_purging)->Arg(0)->Arg(1 << 16)->Arg(1 << 20);
+
+
+void worst_case_split(benchmark::State& state)
+{
+    // Every allocation in an empty arena splits the root all the way down
+    // to a leaf and every deallocation merges the blocks back.
+    const auto size = std::size_t(state.range(0));
+    auto allocator = alc::BuddyAllocator(huge_memory(), size);
+
+    for (auto _ : state)
+    {
+        const auto block = allocator.allocate(1);
+        benchmark::DoNotOptimize(block);
+        allocator.deallocate(block, 1);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(worst_case_split)
+    ->RangeMultiplier(32)->Range(std::size_t(1) << 15, MAX_ARENA_SIZE)
+    ->Repetitions(10)
+    ->ComputeStatistics("max", [](const std::vector<double>& values)
+    {
+        return *std::max_element(values.begin(), values.end());
+    });
+
+
+void batch(benchmark::State& state)
+{
+    constexpr auto SIZE = std::size_t(64);
+    const auto count = std::size_t(state.range(0));
+    auto memory = std::unique_ptr<char[]>(new char[ARENA_SIZE]);
+    auto allocator = alc::BuddyAllocator(memory.get(), ARENA_SIZE);
+    auto blocks = std::vector<void*>(count);
+
+    for (auto _ : state)
+    {
+        const auto allocated = allocator.allocate_n(SIZE, count, blocks.data());
+        benchmark::ClobberMemory();
+        allocator.deallocate_n(blocks.data(), allocated);
+    }
+
+    state.SetItemsProcessed(state.iterations() * count);
+}
+
+BENCHMARK(batch)->RangeMultiplier(4)->Range(16, 1024);
+
+
+void one_at_a_time(benchmark::State& state)
+{
+    constexpr auto SIZE = std::size_t(64);
+    const auto count = std::size_t(state.range(0));
+    auto memory = std::unique_ptr<char[]>(new char[ARENA_SIZE]);
+    auto allocator = alc::BuddyAllocator(memory.get(), ARENA_SIZE);
+    auto blocks = std::vector<void*>(count);
+
+    for (auto _ : state)
+    {
+        for (auto& block : blocks)
+        {
+            block = allocator.allocate(SIZE);
+        }
+
+        benchmark::ClobberMemory();
+
+        for (auto block : blocks)
+        {
+            allocator.deallocate(block);
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * count);
+}
+
+BENCHMARK(one_at_a_time)->RangeMultiplier(4)->Range(16, 1024);
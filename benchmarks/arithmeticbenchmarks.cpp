@@ -0,0 +1,30 @@
+#include <benchmark/benchmark.h>
+
+#include "arithmetic.hpp"
+#include "workloads.hpp"
+
+namespace alc = allocator;
+using namespace benchmarks;
+
+
+void size_to_level(benchmark::State& state)
+{
+    // The mapping done by every allocation: the block size is rounded up
+    // to a power of two whose logarithm gives the depth in the tree.
+    const auto sizes = random_sizes(1024);
+    const auto levels_count = alc::log2(ARENA_SIZE) + 1;
+
+    for (auto _ : state)
+    {
+        for (auto size : sizes)
+        {
+            benchmark::DoNotOptimize(
+                levels_count - 1 - alc::log2(alc::next_power_of_two(size))
+            );
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * sizes.size());
+}
+
+BENCHMARK(size_to_level);
@@ -0,0 +1,121 @@
+#include <memory>
+
+#include <benchmark/benchmark.h>
+
+#include "bitmap.hpp"
+
+namespace alc = allocator;
+
+
+std::unique_ptr<alc::BitMap::Word[]> storage_for(std::size_t bits)
+{
+    return std::unique_ptr<alc::BitMap::Word[]>(
+        new alc::BitMap::Word[alc::BitMap::storage_size_for(bits) /
+                              sizeof(alc::BitMap::Word)]
+    );
+}
+
+
+unsigned char* as_bytes(const std::unique_ptr<alc::BitMap::Word[]>& words)
+{
+    return reinterpret_cast<unsigned char*>(words.get());
+}
+
+
+void flip_bit_by_bit(benchmark::State& state)
+{
+    const auto size = std::size_t(state.range(0));
+    const auto words = storage_for(size);
+    auto map = alc::BitMap(as_bytes(words), size);
+
+    for (auto _ : state)
+    {
+        for (auto i = std::size_t(0); i < size; ++i)
+        {
+            map.flip(i);
+        }
+
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * size);
+}
+
+BENCHMARK(flip_bit_by_bit)->RangeMultiplier(16)->Range(1 << 8, 1 << 20);
+
+
+void flip_range(benchmark::State& state)
+{
+    const auto size = std::size_t(state.range(0));
+    const auto words = storage_for(size);
+    auto map = alc::BitMap(as_bytes(words), size);
+
+    for (auto _ : state)
+    {
+        map.flip_range(1, size - 1);
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * size);
+}
+
+BENCHMARK(flip_range)->RangeMultiplier(16)->Range(1 << 8, 1 << 20);
+
+
+void find_first_set(benchmark::State& state)
+{
+    // The only set bit is the last one, so the whole map is scanned.
+    const auto size = std::size_t(state.range(0));
+    const auto words = storage_for(size);
+    auto map = alc::BitMap(as_bytes(words), size);
+    map.flip(size - 1);
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(map.find_first_set());
+    }
+
+    state.SetItemsProcessed(state.iterations() * size);
+}
+
+BENCHMARK(find_first_set)->RangeMultiplier(16)->Range(1 << 8, 1 << 20);
+
+
+void find_first_clear(benchmark::State& state)
+{
+    const auto size = std::size_t(state.range(0));
+    const auto words = storage_for(size);
+    auto map = alc::BitMap(as_bytes(words), size, true);
+    map.flip(size - 1);
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(map.find_first_clear());
+    }
+
+    state.SetItemsProcessed(state.iterations() * size);
+}
+
+BENCHMARK(find_first_clear)->RangeMultiplier(16)->Range(1 << 8, 1 << 20);
+
+
+void count(benchmark::State& state)
+{
+    const auto size = std::size_t(state.range(0));
+    const auto words = storage_for(size);
+    auto map = alc::BitMap(as_bytes(words), size);
+
+    for (auto i = std::size_t(0); i < size; i += 3)
+    {
+        map.flip(i);
+    }
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(map.count());
+    }
+
+    state.SetItemsProcessed(state.iterations() * size);
+}
+
+BENCHMARK(count)->RangeMultiplier(16)->Range(1 << 8, 1 << 20);
@@ -0,0 +1,103 @@
+#include "buddymemoryresource.hpp"
+
+#if defined(__BUDDY_MEMORY_RESOURCE_AVAILABLE__)
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "workloads.hpp"
+
+namespace alc = allocator;
+using namespace benchmarks;
+
+
+class BuddyResource
+{
+public:
+    BuddyResource() :
+        memory(new char[ARENA_SIZE]),
+        resource(memory.get(), ARENA_SIZE)
+    {
+    }
+
+    std::pmr::memory_resource* get()
+    {
+        return &resource;
+    }
+
+private:
+    std::unique_ptr<char[]> memory;
+    alc::BuddyMemoryResource resource;
+};
+
+
+class DefaultResource
+{
+public:
+    std::pmr::memory_resource* get()
+    {
+        return std::pmr::get_default_resource();
+    }
+};
+
+
+template <class Resource>
+void pmr_vector_growth(benchmark::State& state)
+{
+    auto resource = Resource{};
+    const auto count = int(state.range(0));
+
+    for (auto _ : state)
+    {
+        auto numbers = std::pmr::vector<int>(resource.get());
+
+        for (auto i = 0; i < count; ++i)
+        {
+            numbers.push_back(i);
+        }
+
+        benchmark::DoNotOptimize(numbers.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * count);
+}
+
+BENCHMARK_TEMPLATE(pmr_vector_growth, BuddyResource)
+    ->RangeMultiplier(16)->Range(16, 1 << 16);
+BENCHMARK_TEMPLATE(pmr_vector_growth, DefaultResource)
+    ->RangeMultiplier(16)->Range(16, 1 << 16);
+
+
+template <class Resource>
+void pmr_unordered_map(benchmark::State& state)
+{
+    auto resource = Resource{};
+    const auto count = int(state.range(0));
+
+    for (auto _ : state)
+    {
+        auto map = std::pmr::unordered_map<int, int>(resource.get());
+
+        for (auto i = 0; i < count; ++i)
+        {
+            map.emplace(i, i);
+        }
+
+        for (auto i = 0; i < count; i += 2)
+        {
+            map.erase(i);
+        }
+
+        benchmark::DoNotOptimize(map.size());
+    }
+
+    state.SetItemsProcessed(state.iterations() * count);
+}
+
+BENCHMARK_TEMPLATE(pmr_unordered_map, BuddyResource)
+    ->RangeMultiplier(16)->Range(16, 1 << 12);
+BENCHMARK_TEMPLATE(pmr_unordered_map, DefaultResource)
+    ->RangeMultiplier(16)->Range(16, 1 << 12);
+
+#endif
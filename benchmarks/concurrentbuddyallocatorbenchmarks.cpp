@@ -0,0 +1,171 @@
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "concurrentbuddyallocator.hpp"
+#include "magazinecache.hpp"
+#include "workloads.hpp"
+
+namespace alc = allocator;
+using namespace benchmarks;
+
+
+constexpr auto LIVE_BLOCKS_PER_THREAD = std::size_t(64);
+
+
+class SharedArena
+{
+public:
+    static alc::ConcurrentBuddyAllocator& allocator()
+    {
+        static const auto memory = std::unique_ptr<char[]>(
+            new char[ARENA_SIZE]
+        );
+        static auto allocator =
+            alc::ConcurrentBuddyAllocator(memory.get(), ARENA_SIZE);
+
+        return allocator;
+    }
+};
+
+
+class CachedArena
+{
+public:
+    CachedArena() :
+        cache(SharedArena::allocator())
+    {
+    }
+
+    void* allocate(std::size_t size)
+    {
+        return cache.allocate(size);
+    }
+
+    void deallocate(void* block, std::size_t size)
+    {
+        cache.deallocate(block, size);
+    }
+
+private:
+    alc::MagazineCache cache;
+};
+
+
+class UncachedArena
+{
+public:
+    void* allocate(std::size_t size)
+    {
+        return SharedArena::allocator().allocate(size);
+    }
+
+    void deallocate(void* block, std::size_t size)
+    {
+        SharedArena::allocator().deallocate(block, size);
+    }
+};
+
+
+// The baseline: a single buddy allocator behind one lock.
+class MutexArena
+{
+public:
+    void* allocate(std::size_t size)
+    {
+        std::lock_guard<std::mutex> guard{ lock() };
+
+        return allocator().allocate(size);
+    }
+
+    void deallocate(void* block, std::size_t size)
+    {
+        std::lock_guard<std::mutex> guard{ lock() };
+        allocator().deallocate(block, size);
+    }
+
+private:
+    static std::mutex& lock()
+    {
+        static std::mutex lock;
+
+        return lock;
+    }
+
+    static alc::BuddyAllocator& allocator()
+    {
+        static const auto memory = std::unique_ptr<char[]>(
+            new char[ARENA_SIZE]
+        );
+        static auto allocator =
+            alc::BuddyAllocator(memory.get(), ARENA_SIZE);
+
+        return allocator;
+    }
+};
+
+
+template <class Arena>
+void concurrent_random_mix(benchmark::State& state)
+{
+    auto arena = Arena{};
+    const auto sizes = random_sizes(LIVE_BLOCKS_PER_THREAD,
+                                    unsigned(state.thread_index()));
+    auto blocks = std::vector<void*>(sizes.size());
+
+    for (auto _ : state)
+    {
+        for (auto i = std::size_t(0); i < sizes.size(); ++i)
+        {
+            blocks[i] = arena.allocate(sizes[i]);
+        }
+
+        benchmark::ClobberMemory();
+
+        for (auto i = std::size_t(0); i < sizes.size(); ++i)
+        {
+            arena.deallocate(blocks[i], sizes[i]);
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * sizes.size());
+}
+
+BENCHMARK_TEMPLATE(concurrent_random_mix, MutexArena)
+    ->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK_TEMPLATE(concurrent_random_mix, UncachedArena)
+    ->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK_TEMPLATE(concurrent_random_mix, CachedArena)
+    ->ThreadRange(1, 8)->UseRealTime();
+
+
+template <class Arena>
+void concurrent_leaves(benchmark::State& state)
+{
+    auto arena = Arena{};
+    void* blocks[LIVE_BLOCKS_PER_THREAD];
+
+    for (auto _ : state)
+    {
+        for (auto& block : blocks)
+        {
+            block = arena.allocate(1);
+        }
+
+        benchmark::ClobberMemory();
+
+        for (auto block : blocks)
+        {
+            arena.deallocate(block, 1);
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * LIVE_BLOCKS_PER_THREAD);
+}
+
+BENCHMARK_TEMPLATE(concurrent_leaves, MutexArena)
+    ->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK_TEMPLATE(concurrent_leaves, UncachedArena)
+    ->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK_TEMPLATE(concurrent_leaves, CachedArena)
+    ->ThreadRange(1, 8)->UseRealTime();
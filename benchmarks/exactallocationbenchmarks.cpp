@@ -0,0 +1,135 @@
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "buddyallocator.hpp"
+#include "workloads.hpp"
+
+namespace alc = allocator;
+using namespace benchmarks;
+
+
+constexpr auto BLOCKS_COUNT = std::size_t(1024);
+constexpr auto PACKING_ARENA_SIZE = std::size_t(1) << 22;
+
+
+class RoundedBuddy
+{
+public:
+    RoundedBuddy(void* memory, std::size_t size) :
+        allocator(memory, size)
+    {
+    }
+
+    void* allocate(std::size_t size)
+    {
+        return allocator.allocate(size);
+    }
+
+    void deallocate(void* block, std::size_t size)
+    {
+        allocator.deallocate(block, size);
+    }
+
+private:
+    alc::BuddyAllocator allocator;
+};
+
+
+class ExactBuddy
+{
+public:
+    ExactBuddy(void* memory, std::size_t size) :
+        allocator(memory, size)
+    {
+    }
+
+    void* allocate(std::size_t size)
+    {
+        return allocator.allocate_exact(size);
+    }
+
+    void deallocate(void* block, std::size_t size)
+    {
+        allocator.deallocate_exact(block, size);
+    }
+
+private:
+    alc::BuddyAllocator allocator;
+};
+
+
+// Sizes just past a power of two are the worst case for rounding, as a
+// block of twice the size is taken for them.
+std::vector<std::size_t> sizes_between(std::size_t min, std::size_t max)
+{
+    auto engine = std::mt19937{ 42 };
+    auto distribution = std::uniform_int_distribution<std::size_t>{ min, max };
+    auto sizes = std::vector<std::size_t>(BLOCKS_COUNT);
+
+    for (auto& size : sizes)
+    {
+        size = distribution(engine);
+    }
+
+    return sizes;
+}
+
+
+template <class Arena>
+double fraction_of_arena_used(std::size_t min, std::size_t max)
+{
+    const auto memory = std::unique_ptr<char[]>(new char[PACKING_ARENA_SIZE]);
+    auto arena = Arena(memory.get(), PACKING_ARENA_SIZE);
+    const auto sizes = sizes_between(min, max);
+    auto requested = std::size_t(0);
+
+    for (auto i = std::size_t(0);
+         arena.allocate(sizes[i % sizes.size()]) != nullptr;
+         ++i)
+    {
+        requested += sizes[i % sizes.size()];
+    }
+
+    return double(requested) / PACKING_ARENA_SIZE;
+}
+
+
+// Allocates and frees blocks of random sizes in the given range. The
+// arena_used counter shows how much of an arena is handed out in
+// requested bytes before the first allocation fails.
+template <class Arena>
+void variable_sizes(benchmark::State& state)
+{
+    const auto min = std::size_t(state.range(0));
+    const auto max = std::size_t(state.range(1));
+    const auto memory = std::unique_ptr<char[]>(new char[ARENA_SIZE]);
+    auto arena = Arena(memory.get(), ARENA_SIZE);
+    const auto sizes = sizes_between(min, max);
+    auto blocks = std::vector<void*>(BLOCKS_COUNT);
+
+    for (auto _ : state)
+    {
+        for (auto i = std::size_t(0); i < BLOCKS_COUNT; ++i)
+        {
+            blocks[i] = arena.allocate(sizes[i]);
+        }
+
+        benchmark::ClobberMemory();
+
+        for (auto i = std::size_t(0); i < BLOCKS_COUNT; ++i)
+        {
+            arena.deallocate(blocks[i], sizes[i]);
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * BLOCKS_COUNT);
+    state.counters["arena_used"] = fraction_of_arena_used<Arena>(min, max);
+}
+
+BENCHMARK_TEMPLATE(variable_sizes, RoundedBuddy)
+    ->Args({ MIN_BLOCK_SIZE, MAX_BLOCK_SIZE })
+    ->Args({ 1024, 6144 });
+BENCHMARK_TEMPLATE(variable_sizes, ExactBuddy)
+    ->Args({ MIN_BLOCK_SIZE, MAX_BLOCK_SIZE })
+    ->Args({ 1024, 6144 });
@@ -0,0 +1,68 @@
+#include "hugepagearena.hpp"
+
+#if defined(__HUGE_PAGE_ARENA_AVAILABLE__)
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+namespace alc = allocator;
+
+
+const char* name_of(alc::HugePages pages)
+{
+    switch (pages)
+    {
+    case alc::HugePages::huge_tlb:
+        return "huge_tlb";
+    case alc::HugePages::transparent:
+        return "transparent";
+    default:
+        return "none";
+    }
+}
+
+
+template <alc::HugePages Preferred>
+void random_access(benchmark::State& state)
+{
+    // Chases pointers stored in blocks spread over the whole arena, in a
+    // random order, so nearly every step needs a new TLB entry when the
+    // arena is backed by small pages.
+    constexpr auto ARENA_SIZE = std::size_t(1) << 28;
+    constexpr auto BLOCK_SIZE = std::size_t(4096);
+    auto arena = alc::HugePageArena(ARENA_SIZE, Preferred);
+    auto& allocator = arena.get_allocator();
+    auto blocks = std::vector<void**>{};
+
+    while (const auto block = allocator.allocate(BLOCK_SIZE))
+    {
+        blocks.push_back(static_cast<void**>(block));
+    }
+
+    std::shuffle(blocks.begin(), blocks.end(), std::mt19937{ 42 });
+
+    for (auto i = std::size_t(0); i < blocks.size(); ++i)
+    {
+        *blocks[i] = blocks[(i + 1) % blocks.size()];
+    }
+
+    auto p = static_cast<void*>(blocks.front());
+
+    for (auto _ : state)
+    {
+        p = *static_cast<void**>(p);
+        benchmark::DoNotOptimize(p);
+    }
+
+    state.SetLabel(name_of(arena.get_pages()));
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK_TEMPLATE(random_access, alc::HugePages::none);
+BENCHMARK_TEMPLATE(random_access, alc::HugePages::transparent);
+BENCHMARK_TEMPLATE(random_access, alc::HugePages::huge_tlb);
+
+#endif
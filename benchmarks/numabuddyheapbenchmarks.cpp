@@ -0,0 +1,84 @@
+#include "numabuddyheap.hpp"
+
+#if defined(__NUMA_BUDDY_HEAP_AVAILABLE__)
+
+#include <vector>
+
+#include "workloads.hpp"
+
+namespace alc = allocator;
+using namespace benchmarks;
+
+
+// Threads are pinned to nodes synthetically, thread i allocating from
+// node i % SYNTHETIC_NODES_COUNT, so the routing and the split of the
+// arenas are measured on machines with a single node as well. Remote
+// memory latency only shows on machines with several nodes.
+constexpr auto SYNTHETIC_NODES_COUNT = std::size_t(2);
+constexpr auto LIVE_BLOCKS_PER_THREAD = std::size_t(64);
+
+
+template <std::size_t NodesCount>
+class NodeArena
+{
+public:
+    explicit NodeArena(std::size_t thread_index) :
+        node(thread_index % NodesCount)
+    {
+    }
+
+    void* allocate(std::size_t size)
+    {
+        return heap().allocate(size, node);
+    }
+
+    void deallocate(void* block, std::size_t size)
+    {
+        heap().deallocate(block, size);
+    }
+
+private:
+    static alc::NumaBuddyHeap& heap()
+    {
+        static auto heap = alc::NumaBuddyHeap(ARENA_SIZE, NodesCount);
+
+        return heap;
+    }
+
+private:
+    std::size_t node;
+};
+
+
+template <class Arena>
+void node_local_random_mix(benchmark::State& state)
+{
+    auto arena = Arena(std::size_t(state.thread_index()));
+    const auto sizes = random_sizes(LIVE_BLOCKS_PER_THREAD,
+                                    unsigned(state.thread_index()));
+    auto blocks = std::vector<void*>(sizes.size());
+
+    for (auto _ : state)
+    {
+        for (auto i = std::size_t(0); i < sizes.size(); ++i)
+        {
+            blocks[i] = arena.allocate(sizes[i]);
+        }
+
+        benchmark::ClobberMemory();
+
+        for (auto i = std::size_t(0); i < sizes.size(); ++i)
+        {
+            arena.deallocate(blocks[i], sizes[i]);
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * sizes.size());
+}
+
+BENCHMARK_TEMPLATE(node_local_random_mix, NodeArena<1>)
+    ->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK_TEMPLATE(node_local_random_mix, NodeArena<SYNTHETIC_NODES_COUNT>)
+    ->ThreadRange(1, 8)->UseRealTime();
+
+#endif
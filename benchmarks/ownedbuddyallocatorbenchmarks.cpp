@@ -0,0 +1,114 @@
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "concurrentbuddyallocator.hpp"
+#include "ownedbuddyallocator.hpp"
+#include "workloads.hpp"
+
+namespace alc = allocator;
+using namespace benchmarks;
+
+
+constexpr auto MESSAGES_PER_BATCH = std::size_t(64);
+constexpr auto MESSAGE_SIZE = std::size_t(512);
+
+
+// Messages are allocated by the benchmark's thread and freed by a
+// consumer thread, which takes them in batches from a mailbox.
+template <class Allocator>
+class Pipeline
+{
+public:
+    Pipeline() :
+        memory(new char[ARENA_SIZE]),
+        allocator(memory.get(), ARENA_SIZE),
+        done(false),
+        consumer([this]() { consume(); })
+    {
+    }
+
+    ~Pipeline()
+    {
+        done.store(true);
+        consumer.join();
+    }
+
+    void* allocate(std::size_t size)
+    {
+        return allocator.allocate(size);
+    }
+
+    void send(std::vector<void*>& messages)
+    {
+        std::lock_guard<std::mutex> guard{ lock };
+        mailbox.insert(mailbox.end(), messages.begin(), messages.end());
+        messages.clear();
+    }
+
+private:
+    void consume()
+    {
+        auto messages = std::vector<void*>{};
+        auto finished = false;
+
+        while (!finished)
+        {
+            finished = done.load();
+            {
+                std::lock_guard<std::mutex> guard{ lock };
+                messages.swap(mailbox);
+            }
+
+            for (const auto message : messages)
+            {
+                allocator.deallocate(message, MESSAGE_SIZE);
+            }
+
+            messages.clear();
+        }
+    }
+
+private:
+    std::unique_ptr<char[]> memory;
+    Allocator allocator;
+    std::mutex lock;
+    std::vector<void*> mailbox;
+    std::atomic<bool> done;
+    std::thread consumer;
+};
+
+
+template <class Allocator>
+void producer_consumer(benchmark::State& state)
+{
+    Pipeline<Allocator> pipeline;
+    auto messages = std::vector<void*>{};
+
+    for (auto _ : state)
+    {
+        for (auto i = std::size_t(0); i < MESSAGES_PER_BATCH; ++i)
+        {
+            auto message = pipeline.allocate(MESSAGE_SIZE);
+
+            while (message == nullptr)
+            {
+                std::this_thread::yield();
+                message = pipeline.allocate(MESSAGE_SIZE);
+            }
+
+            messages.push_back(message);
+        }
+
+        pipeline.send(messages);
+    }
+
+    state.SetItemsProcessed(state.iterations() * MESSAGES_PER_BATCH);
+}
+
+BENCHMARK_TEMPLATE(producer_consumer, alc::ConcurrentBuddyAllocator)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(producer_consumer, alc::OwnedBuddyAllocator)
+    ->UseRealTime();
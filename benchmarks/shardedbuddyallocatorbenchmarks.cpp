@@ -0,0 +1,76 @@
+#include <memory>
+#include <vector>
+
+#include "shardedbuddyallocator.hpp"
+#include "workloads.hpp"
+
+namespace alc = allocator;
+using namespace benchmarks;
+
+
+constexpr auto SHARDED_LIVE_BLOCKS_PER_THREAD = std::size_t(64);
+
+
+// A single shard is one buddy allocator behind one lock, the baseline
+// the sharded configurations scale against.
+template <std::size_t ShardsCount>
+class ShardedArena
+{
+public:
+    void* allocate(std::size_t size)
+    {
+        return allocator().allocate(size);
+    }
+
+    void deallocate(void* block, std::size_t size)
+    {
+        allocator().deallocate(block, size);
+    }
+
+private:
+    static alc::ShardedBuddyAllocator& allocator()
+    {
+        static const auto memory = std::unique_ptr<char[]>(
+            new char[ARENA_SIZE]
+        );
+        static auto allocator = alc::ShardedBuddyAllocator(memory.get(),
+                                                           ARENA_SIZE,
+                                                           ShardsCount);
+
+        return allocator;
+    }
+};
+
+
+template <class Arena>
+void sharded_random_mix(benchmark::State& state)
+{
+    auto arena = Arena{};
+    const auto sizes = random_sizes(SHARDED_LIVE_BLOCKS_PER_THREAD,
+                                    unsigned(state.thread_index()));
+    auto blocks = std::vector<void*>(sizes.size());
+
+    for (auto _ : state)
+    {
+        for (auto i = std::size_t(0); i < sizes.size(); ++i)
+        {
+            blocks[i] = arena.allocate(sizes[i]);
+        }
+
+        benchmark::ClobberMemory();
+
+        for (auto i = std::size_t(0); i < sizes.size(); ++i)
+        {
+            arena.deallocate(blocks[i], sizes[i]);
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * sizes.size());
+}
+
+BENCHMARK_TEMPLATE(sharded_random_mix, ShardedArena<1>)
+    ->ThreadRange(1, 64)->UseRealTime();
+BENCHMARK_TEMPLATE(sharded_random_mix, ShardedArena<8>)
+    ->ThreadRange(1, 64)->UseRealTime();
+BENCHMARK_TEMPLATE(sharded_random_mix, ShardedArena<64>)
+    ->ThreadRange(1, 64)->UseRealTime();
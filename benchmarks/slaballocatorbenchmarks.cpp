@@ -0,0 +1,113 @@
+#include <memory>
+#include <vector>
+
+#include "slaballocator.hpp"
+#include "workloads.hpp"
+
+namespace alc = allocator;
+using namespace benchmarks;
+
+
+constexpr auto NODES_COUNT = std::size_t(1024);
+constexpr auto PACKING_ARENA_SIZE = std::size_t(1) << 20;
+
+
+class PlainBuddy
+{
+public:
+    PlainBuddy(void* memory, std::size_t size) :
+        allocator(memory, size)
+    {
+    }
+
+    void* allocate(std::size_t size)
+    {
+        return allocator.allocate(size);
+    }
+
+    void deallocate(void* block, std::size_t size)
+    {
+        allocator.deallocate(block, size);
+    }
+
+private:
+    alc::BuddyAllocator allocator;
+};
+
+
+class SlabOverBuddy
+{
+public:
+    SlabOverBuddy(void* memory, std::size_t size) :
+        buddy(memory, size),
+        allocator(buddy)
+    {
+    }
+
+    void* allocate(std::size_t size)
+    {
+        return allocator.allocate(size);
+    }
+
+    void deallocate(void* block, std::size_t size)
+    {
+        allocator.deallocate(block, size);
+    }
+
+private:
+    alc::BuddyAllocator buddy;
+    alc::SlabAllocator allocator;
+};
+
+
+template <class Arena>
+std::size_t objects_fitting_in_arena(std::size_t size)
+{
+    const auto memory = std::unique_ptr<char[]>(new char[PACKING_ARENA_SIZE]);
+    auto arena = Arena(memory.get(), PACKING_ARENA_SIZE);
+    auto count = std::size_t(0);
+
+    while (arena.allocate(size) != nullptr)
+    {
+        ++count;
+    }
+
+    return count;
+}
+
+
+// Allocates and frees small list nodes. The objects_per_MiB counter shows
+// how tightly each arena packs nodes of the size.
+template <class Arena, std::size_t Size>
+void small_nodes(benchmark::State& state)
+{
+    const auto memory = std::unique_ptr<char[]>(new char[ARENA_SIZE]);
+    auto arena = Arena(memory.get(), ARENA_SIZE);
+    auto nodes = std::vector<void*>(NODES_COUNT);
+
+    for (auto _ : state)
+    {
+        for (auto& node : nodes)
+        {
+            node = arena.allocate(Size);
+        }
+
+        benchmark::ClobberMemory();
+
+        for (const auto node : nodes)
+        {
+            arena.deallocate(node, Size);
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * NODES_COUNT);
+    state.counters["objects_per_MiB"] =
+        double(objects_fitting_in_arena<Arena>(Size));
+}
+
+BENCHMARK_TEMPLATE(small_nodes, PlainBuddy, 24);
+BENCHMARK_TEMPLATE(small_nodes, SlabOverBuddy, 24);
+BENCHMARK_TEMPLATE(small_nodes, PlainBuddy, 40);
+BENCHMARK_TEMPLATE(small_nodes, SlabOverBuddy, 40);
+BENCHMARK_TEMPLATE(small_nodes, PlainBuddy, 128);
+BENCHMARK_TEMPLATE(small_nodes, SlabOverBuddy, 128);
@@ -0,0 +1,298 @@
+#ifndef __WORKLOADS_HEADER_INCLUDED__
+#define __WORKLOADS_HEADER_INCLUDED__
+
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <vector>
+
+#if __cplusplus >= 201703L && __has_include(<memory_resource>)
+#define __BENCHMARK_PMR_RESOURCES__
+#include <memory_resource>
+#endif
+
+#include <benchmark/benchmark.h>
+
+#include "buddyallocator.hpp"
+#include "growablebuddyheap.hpp"
+
+
+namespace benchmarks
+{
+    constexpr std::size_t ARENA_SIZE = std::size_t(1) << 26;
+    constexpr std::size_t MIN_BLOCK_SIZE = 16;
+    constexpr std::size_t MAX_BLOCK_SIZE = 4096;
+
+
+    template <allocator::LevelLookup Lookup, bool FreesWithSize>
+    class BuddyAllocatorAdaptor
+    {
+    public:
+        BuddyAllocatorAdaptor() :
+            memory(new char[ARENA_SIZE]),
+            allocator(memory.get(), ARENA_SIZE, Lookup)
+        {
+        }
+
+        void* allocate(std::size_t size)
+        {
+            return allocator.allocate(size);
+        }
+
+        void deallocate(void* block, std::size_t size)
+        {
+            if (FreesWithSize)
+            {
+                allocator.deallocate(block, size);
+            }
+            else
+            {
+                allocator.deallocate(block);
+            }
+        }
+
+    private:
+        std::unique_ptr<char[]> memory;
+        allocator::BuddyAllocator allocator;
+    };
+
+
+    using SizedBuddy =
+        BuddyAllocatorAdaptor<allocator::LevelLookup::split_map, true>;
+    using UnsizedBuddy =
+        BuddyAllocatorAdaptor<allocator::LevelLookup::split_map, false>;
+    using UnsizedBuddyWithLevelMap =
+        BuddyAllocatorAdaptor<allocator::LevelLookup::level_map, false>;
+
+
+#if defined(__GROWABLE_BUDDY_HEAP_AVAILABLE__)
+    class GrowableHeapAdaptor : public allocator::GrowableBuddyHeap
+    {
+    public:
+        GrowableHeapAdaptor() :
+            GrowableBuddyHeap(ARENA_SIZE / 16)
+        {
+        }
+    };
+#endif
+
+
+    class MallocAdaptor
+    {
+    public:
+        void* allocate(std::size_t size)
+        {
+            return std::malloc(size);
+        }
+
+        void deallocate(void* block, std::size_t)
+        {
+            std::free(block);
+        }
+    };
+
+
+#if defined(__BENCHMARK_PMR_RESOURCES__)
+    class PoolResourceAdaptor
+    {
+    public:
+        void* allocate(std::size_t size)
+        {
+            return resource.allocate(size);
+        }
+
+        void deallocate(void* block, std::size_t size)
+        {
+            resource.deallocate(block, size);
+        }
+
+    private:
+        std::pmr::unsynchronized_pool_resource resource;
+    };
+
+
+    class MonotonicResourceAdaptor
+    {
+    public:
+        MonotonicResourceAdaptor() :
+            memory(new char[ARENA_SIZE]),
+            resource(memory.get(), ARENA_SIZE),
+            live_blocks(0)
+        {
+        }
+
+        void* allocate(std::size_t size)
+        {
+            ++live_blocks;
+
+            return resource.allocate(size);
+        }
+
+        // Memory is only reclaimed when nothing is alive, which is how a
+        // monotonic resource is meant to be used.
+        void deallocate(void*, std::size_t)
+        {
+            if (--live_blocks == 0)
+            {
+                resource.release();
+            }
+        }
+
+    private:
+        std::unique_ptr<char[]> memory;
+        std::pmr::monotonic_buffer_resource resource;
+        std::size_t live_blocks;
+    };
+#endif
+
+
+    inline std::vector<std::size_t> random_sizes(std::size_t count,
+                                                 unsigned seed = 42)
+    {
+        // Small blocks are much more common than big ones, so the sizes
+        // are spread uniformly over their logarithms.
+        auto engine = std::mt19937{ seed };
+        auto exponents = std::uniform_real_distribution<double>{
+            std::log2(double(MIN_BLOCK_SIZE)),
+            std::log2(double(MAX_BLOCK_SIZE))
+        };
+        auto result = std::vector<std::size_t>(count);
+
+        for (auto& size : result)
+        {
+            size = std::size_t(std::exp2(exponents(engine)));
+        }
+
+        return result;
+    }
+
+
+    template <class Allocator>
+    void single_size(benchmark::State& state)
+    {
+        auto allocator = Allocator{};
+        const auto size = std::size_t(state.range(0));
+
+        for (auto _ : state)
+        {
+            const auto block = allocator.allocate(size);
+            benchmark::DoNotOptimize(block);
+            allocator.deallocate(block, size);
+        }
+
+        state.SetItemsProcessed(state.iterations());
+    }
+
+
+    template <class Allocator>
+    void random_mix(benchmark::State& state)
+    {
+        auto allocator = Allocator{};
+        const auto sizes = random_sizes(std::size_t(state.range(0)));
+        auto blocks = std::vector<void*>(sizes.size());
+
+        for (auto _ : state)
+        {
+            for (auto i = std::size_t(0); i < sizes.size(); ++i)
+            {
+                blocks[i] = allocator.allocate(sizes[i]);
+            }
+
+            benchmark::ClobberMemory();
+
+            for (auto i = std::size_t(0); i < sizes.size(); ++i)
+            {
+                allocator.deallocate(blocks[i], sizes[i]);
+            }
+        }
+
+        state.SetItemsProcessed(state.iterations() * sizes.size());
+    }
+
+
+    template <class Allocator>
+    void free_in_order(benchmark::State& state, bool last_in_first_out)
+    {
+        auto allocator = Allocator{};
+        const auto count = std::size_t(state.range(0));
+        const auto size = std::size_t(state.range(1));
+        auto blocks = std::vector<void*>(count);
+
+        for (auto _ : state)
+        {
+            for (auto& block : blocks)
+            {
+                block = allocator.allocate(size);
+            }
+
+            benchmark::ClobberMemory();
+
+            for (auto i = std::size_t(0); i < count; ++i)
+            {
+                allocator.deallocate(
+                    blocks[last_in_first_out ? count - 1 - i : i],
+                    size
+                );
+            }
+        }
+
+        state.SetItemsProcessed(state.iterations() * count);
+    }
+
+
+    template <class Allocator>
+    void lifo_free(benchmark::State& state)
+    {
+        free_in_order<Allocator>(state, true);
+    }
+
+
+    template <class Allocator>
+    void fifo_free(benchmark::State& state)
+    {
+        free_in_order<Allocator>(state, false);
+    }
+
+
+    template <class Allocator>
+    void churn(benchmark::State& state)
+    {
+        // A long running mix which keeps a fixed number of blocks alive
+        // and replaces a random one each time, fragmenting the arena.
+        constexpr auto SIZES_COUNT = std::size_t(1) << 16;
+        auto allocator = Allocator{};
+        const auto live_count = std::size_t(state.range(0));
+        const auto sizes = random_sizes(SIZES_COUNT);
+        auto victims = std::mt19937{ 7 };
+        auto blocks = std::vector<void*>(live_count);
+        auto block_sizes = std::vector<std::size_t>(live_count);
+        auto next_size = std::size_t(0);
+
+        for (auto i = std::size_t(0); i < live_count; ++i)
+        {
+            block_sizes[i] = sizes[next_size++];
+            blocks[i] = allocator.allocate(block_sizes[i]);
+        }
+
+        for (auto _ : state)
+        {
+            const auto victim = victims() % live_count;
+            allocator.deallocate(blocks[victim], block_sizes[victim]);
+            block_sizes[victim] = sizes[next_size++ % SIZES_COUNT];
+            blocks[victim] = allocator.allocate(block_sizes[victim]);
+            benchmark::DoNotOptimize(blocks[victim]);
+        }
+
+        for (auto i = std::size_t(0); i < live_count; ++i)
+        {
+            allocator.deallocate(blocks[i], block_sizes[i]);
+        }
+
+        state.SetItemsProcessed(state.iterations());
+    }
+
+}
+
+#endif // __WORKLOADS_HEADER_INCLUDED__
@@ -52,6 +52,8 @@ TEST_CASE("powers of two", "[arithmetic][powers of two]")
         CHECK(next_power_of_two(17) == 32);
         CHECK(next_power_of_two(256) == 256);
         CHECK(next_power_of_two(4095) == 4096);
+        CHECK(next_power_of_two((std::size_t(1) << 40) + 1) ==
+              std::size_t(1) << 41);
     }
 
     SECTION("computing powers of two")
@@ -59,6 +61,16 @@ TEST_CASE("powers of two", "[arithmetic][powers of two]")
         CHECK(two_to_the_power_of(0) == 1);
         CHECK(two_to_the_power_of(5) == 32);
         CHECK(two_to_the_power_of(10) == 1024);
+        CHECK(two_to_the_power_of(SIZE_T_SIZE_IN_BITS - 1) ==
+              std::size_t(1) << (SIZE_T_SIZE_IN_BITS - 1));
+    }
+
+    SECTION("checking for powers of two")
+    {
+        CHECK_FALSE(is_power_of_two(0));
+        CHECK(is_power_of_two(1));
+        CHECK(is_power_of_two(64));
+        CHECK_FALSE(is_power_of_two(96));
     }
 
     SECTION("logarithm returns the index of the most significant bit")
@@ -70,6 +82,24 @@ TEST_CASE("powers of two", "[arithmetic][powers of two]")
         CHECK(log2(32) == 5);
         CHECK(log2(1024) == 10);
         CHECK(log2(1030) == 10);
+        CHECK(log2(~std::size_t(0)) == SIZE_T_SIZE_IN_BITS - 1);
+    }
+
+    SECTION("counting leading and trailing zeros")
+    {
+        CHECK(count_leading_zeros(1) == SIZE_T_SIZE_IN_BITS - 1);
+        CHECK(count_leading_zeros(~std::size_t(0)) == 0);
+        CHECK(count_trailing_zeros(1) == 0);
+        CHECK(count_trailing_zeros(96) == 5);
+        CHECK(count_trailing_zeros(std::size_t(1) << (SIZE_T_SIZE_IN_BITS - 1))
+              == SIZE_T_SIZE_IN_BITS - 1);
+    }
+
+    SECTION("the functions can be evaluated at compile time")
+    {
+        static_assert(allocator::log2(64) == 6, "");
+        static_assert(next_power_of_two(100) == 128, "");
+        static_assert(two_to_the_power_of(7) == 128, "");
     }
 
 }
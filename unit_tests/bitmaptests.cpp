@@ -1,3 +1,6 @@
+#include <algorithm>
+#include <iterator>
+
 #include "catch.hpp"
 
 #include "bitmap.hpp"
@@ -5,9 +8,9 @@
 using namespace allocator;
 
 
-constexpr auto SIZE = 8u;
+constexpr auto SIZE = 32u;
 constexpr auto SIZE_IN_BITS = 8 * SIZE;
-static unsigned char memory[SIZE];
+alignas(BitMap::Word) static unsigned char memory[SIZE];
 
 
 TEST_CASE("BitMap special methods", "[bit map][special methods]")
@@ -47,6 +50,32 @@ TEST_CASE("BitMap special methods", "[bit map][special methods]")
 
     }
 
+    SECTION("map over zero-filled memory")
+    {
+        SECTION("all bits are clear")
+        {
+            std::fill(std::begin(memory), std::end(memory), 0);
+            auto map = BitMap::over_zero_filled(memory, SIZE_IN_BITS);
+
+            REQUIRE(map.get_size() == SIZE_IN_BITS);
+            REQUIRE(map.count() == 0);
+            map.flip(SIZE_IN_BITS - 1);
+            REQUIRE(map.at(SIZE_IN_BITS - 1));
+        }
+
+        SECTION("the memory is not written")
+        {
+            std::fill(std::begin(memory), std::end(memory), 0xFF);
+            const auto map = BitMap::over_zero_filled(memory, SIZE_IN_BITS);
+
+            REQUIRE(std::all_of(std::begin(memory),
+                                std::end(memory),
+                                [](auto byte) { return byte == 0xFF; }));
+            REQUIRE(map.at(0));
+        }
+
+    }
+
     SECTION("move ctor")
     {
         SECTION("from empty map")
@@ -133,6 +162,113 @@ TEST_CASE("bit manipulation", "[bit map]")
 }
 
 
+TEST_CASE("BitMap range operations", "[bit map][range]")
+{
+    constexpr auto BITS = BitMap::WORD_SIZE_IN_BITS;
+    auto map = BitMap(memory, SIZE_IN_BITS);
+
+    SECTION("empty ranges are no-ops")
+    {
+        map.set_range(5, 5);
+        map.flip_range(SIZE_IN_BITS, SIZE_IN_BITS);
+
+        REQUIRE(map.count() == 0);
+    }
+
+    SECTION("range within a single word")
+    {
+        map.set_range(3, 7);
+
+        CHECK_FALSE(map.at(2));
+        CHECK(map.at(3));
+        CHECK(map.at(6));
+        CHECK_FALSE(map.at(7));
+        REQUIRE(map.count() == 4);
+    }
+
+    SECTION("range spanning several words")
+    {
+        map.set_range(BITS - 3, 2 * BITS + 5);
+
+        CHECK_FALSE(map.at(BITS - 4));
+        CHECK(map.at(BITS - 3));
+        CHECK(map.at(BITS));
+        CHECK(map.at(2 * BITS + 4));
+        CHECK_FALSE(map.at(2 * BITS + 5));
+        REQUIRE(map.count() == BITS + 8);
+    }
+
+    SECTION("clearing a range")
+    {
+        map.set_range(0, SIZE_IN_BITS);
+        map.clear_range(1, SIZE_IN_BITS - 1);
+
+        CHECK(map.at(0));
+        CHECK(map.at(SIZE_IN_BITS - 1));
+        REQUIRE(map.count() == 2);
+    }
+
+    SECTION("flipping a range")
+    {
+        map.flip(BITS);
+        map.flip_range(BITS - 1, BITS + 2);
+
+        CHECK(map.at(BITS - 1));
+        CHECK_FALSE(map.at(BITS));
+        CHECK(map.at(BITS + 1));
+        REQUIRE(map.count() == 2);
+    }
+
+}
+
+
+TEST_CASE("BitMap search", "[bit map][search]")
+{
+    constexpr auto BITS = BitMap::WORD_SIZE_IN_BITS;
+
+    SECTION("in a map with no set bits")
+    {
+        const auto map = BitMap(memory, SIZE_IN_BITS);
+
+        CHECK(map.find_first_set() == SIZE_IN_BITS);
+        CHECK(map.find_first_clear() == 0);
+        CHECK(map.find_first_clear(SIZE_IN_BITS - 1) == SIZE_IN_BITS - 1);
+    }
+
+    SECTION("in a map with all bits set")
+    {
+        const auto map = BitMap(memory, SIZE_IN_BITS, true);
+
+        CHECK(map.find_first_set(7) == 7);
+        CHECK(map.find_first_clear() == SIZE_IN_BITS);
+        REQUIRE(map.count() == SIZE_IN_BITS);
+    }
+
+    SECTION("search starts from the given bit")
+    {
+        auto map = BitMap(memory, SIZE_IN_BITS);
+        map.flip(2);
+        map.flip(3 * BITS + 1);
+
+        CHECK(map.find_first_set() == 2);
+        CHECK(map.find_first_set(2) == 2);
+        CHECK(map.find_first_set(3) == 3 * BITS + 1);
+        CHECK(map.find_first_set(3 * BITS + 2) == SIZE_IN_BITS);
+        CHECK(map.find_first_set(SIZE_IN_BITS) == SIZE_IN_BITS);
+    }
+
+    SECTION("bits past the end of the map are ignored")
+    {
+        const auto map = BitMap(memory, BITS + 3, true);
+
+        CHECK(map.find_first_clear() == BITS + 3);
+        CHECK(map.find_first_clear(BITS + 1) == BITS + 3);
+        CHECK(map.count() == BITS + 3);
+    }
+
+}
+
+
 TEST_CASE("BitMap size related methods", "[bit map][size]")
 {
     const auto empty_map = BitMap{};
@@ -1,5 +1,8 @@
+#include <algorithm>
+#include <iterator>
 #include <stdexcept>
 #include <unordered_set>
+#include <vector>
 
 #include "catch.hpp"
 
@@ -12,6 +15,7 @@ namespace alc = allocator;
 constexpr auto MIN_SIZE = 256u;
 constexpr auto SIZE = 4096u;
 alignas(std::max_align_t) static char memory[SIZE];
+alignas(SIZE) static char aligned_memory[SIZE];
 
 
 struct AllocationsResult
@@ -21,8 +25,8 @@ struct AllocationsResult
 };
 
 
-AllocationsResult
-allocate_memory_in_small_blocks(alc::BuddyAllocator& allocator)
+template <class Allocator>
+AllocationsResult allocate_memory_in_small_blocks(Allocator& allocator)
 {
     auto result = AllocationsResult{};
 
@@ -49,8 +53,9 @@ allocate_memory_in_small_blocks(alc::BuddyAllocator& allocator)
 }
 
 
+template <class Allocator>
 void deallocate(const std::unordered_set<void*>& blocks,
-                alc::BuddyAllocator& allocator)
+                Allocator& allocator)
 {
     for (auto block : blocks)
     {
@@ -65,6 +70,12 @@ std::uintptr_t value_of(void* ptr)
 }
 
 
+void* add_to(void* ptr, std::size_t offset)
+{
+    return static_cast<char*>(ptr) + offset;
+}
+
+
 bool is_within_memory_block(void* ptr,
                             void* block = memory,
                             std::size_t size = SIZE)
@@ -79,31 +90,34 @@ bool is_within_memory_block(void* ptr,
 }
 
 
-bool is_correctly_aligned(void* ptr)
+bool is_correctly_aligned(void* ptr,
+                          std::size_t alignment = alignof(std::max_align_t))
 {
-    return value_of(ptr) % alignof(std::max_align_t) == 0;
+    return value_of(ptr) % alignment == 0;
 }
 
 
 bool is_valid_pointer(void* ptr,
                       void* block = memory,
-                      std::size_t size = SIZE)
+                      std::size_t size = SIZE,
+                      std::size_t alignment = alignof(std::max_align_t))
 {
     return is_within_memory_block(ptr, block, size) &&
-           is_correctly_aligned(ptr);
+           is_correctly_aligned(ptr, alignment);
 }
 
 
 bool are_valid_pointers(const std::unordered_set<void*>& blocks,
                         void* memory_block = memory,
-                        std::size_t size = SIZE)
+                        std::size_t size = SIZE,
+                        std::size_t alignment = alignof(std::max_align_t))
 {
     return std::all_of(
         blocks.begin(),
         blocks.end(),
-        [memory_block, size](auto block)
+        [memory_block, size, alignment](auto block)
         {
-            return is_valid_pointer(block, memory_block, size);
+            return is_valid_pointer(block, memory_block, size, alignment);
         }
     );
 }
@@ -283,3 +297,912 @@ TEST_CASE("BuddyAllocator allocation and deallocation",
     }
 
 }
+
+
+TEST_CASE("BasicBuddyAllocator with custom leaf size and alignment",
+          "[buddy allocator][leaf size]")
+{
+    SECTION("small leaves")
+    {
+        using SmallLeavesAllocator = alc::BasicBuddyAllocator<32, 16>;
+        const auto size = SIZE / 2;
+        auto allocator = SmallLeavesAllocator(memory, size);
+        auto default_allocator = alc::BuddyAllocator(memory + size, size);
+
+        const auto allocation = allocate_memory_in_small_blocks(allocator);
+
+        REQUIRE_FALSE(allocation.an_address_was_duplicated);
+        REQUIRE(are_valid_pointers(allocation.blocks, memory, size, 16));
+        REQUIRE(allocation.blocks.size() >
+                2 * allocate_memory_in_small_blocks(default_allocator)
+                    .blocks.size());
+        deallocate(allocation.blocks, allocator);
+        REQUIRE(allocator.allocate(size / 2) != nullptr);
+    }
+
+    SECTION("page sized leaves")
+    {
+        constexpr auto PAGE_SIZE = 4096u;
+        constexpr auto PAGES_COUNT = 16u;
+        alignas(PAGE_SIZE) static char pages[PAGES_COUNT * PAGE_SIZE];
+        using PageAllocator = alc::BasicBuddyAllocator<PAGE_SIZE, PAGE_SIZE>;
+        auto allocator = PageAllocator(pages + 1, sizeof(pages) - 1);
+
+        const auto allocation = allocate_memory_in_small_blocks(allocator);
+
+        REQUIRE(allocation.blocks.size() == PAGES_COUNT - 2);
+        REQUIRE(are_valid_pointers(allocation.blocks,
+                                   pages,
+                                   sizeof(pages),
+                                   PAGE_SIZE));
+        deallocate(allocation.blocks, allocator);
+    }
+
+}
+
+
+TEST_CASE("BuddyAllocator with a level map",
+          "[buddy allocator][level map]")
+{
+    constexpr auto LEAF_SIZE = 128u;
+    const auto memory_block = memory + 1;
+    const auto size = SIZE - 1;
+
+    SECTION("the map costs at most a byte per leaf")
+    {
+        auto plain_allocator = alc::BuddyAllocator(memory_block, size);
+        const auto plain_leaves_count =
+            allocate_memory_in_small_blocks(plain_allocator).blocks.size();
+        auto allocator = alc::BuddyAllocator(memory_block,
+                                             size,
+                                             alc::LevelLookup::level_map);
+        const auto leaves_count =
+            allocate_memory_in_small_blocks(allocator).blocks.size();
+
+        REQUIRE(leaves_count <= plain_leaves_count);
+        REQUIRE(plain_leaves_count - leaves_count <=
+                alc::blocks_fitting(SIZE / LEAF_SIZE, LEAF_SIZE) + 1);
+    }
+
+    SECTION("the minimum size for the block does not change")
+    {
+        REQUIRE_NOTHROW(alc::BuddyAllocator(memory,
+                                            2 * LEAF_SIZE,
+                                            alc::LevelLookup::level_map));
+    }
+
+    SECTION("unsized deallocation of blocks with different sizes")
+    {
+        auto allocator = alc::BuddyAllocator(memory_block,
+                                             size,
+                                             alc::LevelLookup::level_map);
+        const auto initial_allocation =
+            allocate_memory_in_small_blocks(allocator);
+        deallocate(initial_allocation.blocks, allocator);
+        auto blocks = std::vector<void*>{};
+
+        for (auto block_size : { 1u, 256u, 1u, 512u, 128u, 256u, 1024u })
+        {
+            blocks.push_back(allocator.allocate(block_size));
+            REQUIRE(blocks.back() != nullptr);
+        }
+
+        std::reverse(blocks.begin(), blocks.end());
+
+        for (auto block : blocks)
+        {
+            allocator.deallocate(block);
+        }
+
+        const auto big_block = allocator.allocate(size / 2);
+        REQUIRE(big_block != nullptr);
+        allocator.deallocate(big_block);
+        REQUIRE(allocate_memory_in_small_blocks(allocator).blocks ==
+                initial_allocation.blocks);
+    }
+
+}
+
+
+TEST_CASE("BuddyAllocator over zero-filled memory",
+          "[buddy allocator][zero-filled memory]")
+{
+    const auto memory_block = memory + 1;
+    const auto size = SIZE - 1;
+
+    for (auto lookup : { alc::LevelLookup::split_map,
+                         alc::LevelLookup::level_map })
+    {
+        std::fill(std::begin(memory), std::end(memory), 1);
+        auto eager_allocator = alc::BuddyAllocator(memory_block,
+                                                   size,
+                                                   lookup);
+        const auto expected_blocks =
+            allocate_memory_in_small_blocks(eager_allocator).blocks;
+
+        std::fill(std::begin(memory), std::end(memory), 0);
+        auto allocator = alc::BuddyAllocator(memory_block,
+                                             size,
+                                             lookup,
+                                             alc::MemoryContents::zero_filled);
+        const auto result = allocate_memory_in_small_blocks(allocator);
+
+        REQUIRE(result.blocks == expected_blocks);
+        deallocate(result.blocks, allocator);
+        const auto big_block = allocator.allocate(size / 2);
+        REQUIRE(big_block != nullptr);
+        allocator.deallocate(big_block);
+    }
+}
+
+
+TEST_CASE("BuddyAllocator with external metadata",
+          "[buddy allocator][external metadata]")
+{
+    constexpr auto LEAF_SIZE = 128u;
+    constexpr auto METADATA_SIZE =
+        alc::BuddyAllocator::required_metadata_size(
+            SIZE,
+            alc::LevelLookup::level_map
+        );
+    static_assert(METADATA_SIZE > 0, "SIZE is big enough for an arena!");
+    static char metadata[METADATA_SIZE + 1];
+
+    SECTION("required_metadata_size")
+    {
+        REQUIRE(alc::BuddyAllocator::required_metadata_size(MIN_SIZE - 1) ==
+                0);
+        REQUIRE(alc::BuddyAllocator::required_metadata_size(SIZE) <
+                METADATA_SIZE);
+        REQUIRE(alc::BuddyAllocator::required_metadata_size(2 * SIZE) >
+                alc::BuddyAllocator::required_metadata_size(SIZE));
+    }
+
+    SECTION("ctor throws for missing or insufficient metadata")
+    {
+        REQUIRE_THROWS_AS(
+            alc::BuddyAllocator(aligned_memory, SIZE, nullptr, METADATA_SIZE),
+            std::invalid_argument
+        );
+        REQUIRE_THROWS_AS(
+            alc::BuddyAllocator(
+                aligned_memory,
+                SIZE,
+                metadata,
+                alc::BuddyAllocator::required_metadata_size(SIZE) - 1
+            ),
+            alc::InsufficientMemory
+        );
+    }
+
+    SECTION("the whole block can be allocated")
+    {
+        auto allocator = alc::BuddyAllocator(aligned_memory,
+                                             SIZE,
+                                             metadata,
+                                             METADATA_SIZE);
+
+        REQUIRE(allocator.allocate(SIZE) == aligned_memory);
+        allocator.deallocate(aligned_memory, SIZE);
+
+        const auto leaves = allocate_memory_in_small_blocks(allocator);
+        REQUIRE(leaves.blocks.size() == SIZE / LEAF_SIZE);
+        REQUIRE(are_valid_pointers(leaves.blocks, aligned_memory));
+    }
+
+    SECTION("misaligned block and metadata with a level map")
+    {
+        std::fill(std::begin(metadata), std::end(metadata), 0);
+        auto allocator = alc::BuddyAllocator(memory + 1,
+                                             SIZE - 1,
+                                             metadata + 1,
+                                             METADATA_SIZE,
+                                             alc::LevelLookup::level_map,
+                                             alc::MemoryContents::zero_filled);
+        const auto initial_allocation =
+            allocate_memory_in_small_blocks(allocator);
+
+        REQUIRE(initial_allocation.blocks.size() == SIZE / LEAF_SIZE - 1);
+        REQUIRE_FALSE(initial_allocation.an_address_was_duplicated);
+        REQUIRE(are_valid_pointers(initial_allocation.blocks));
+        deallocate(initial_allocation.blocks, allocator);
+
+        auto blocks = std::vector<void*>{};
+
+        for (auto block_size : { 1u, 256u, 1u, 512u, 128u, 256u, 1024u })
+        {
+            blocks.push_back(allocator.allocate(block_size));
+            REQUIRE(blocks.back() != nullptr);
+        }
+
+        for (auto block : blocks)
+        {
+            allocator.deallocate(block);
+        }
+
+        REQUIRE(allocate_memory_in_small_blocks(allocator).blocks ==
+                initial_allocation.blocks);
+    }
+
+}
+
+
+TEST_CASE("BuddyAllocator aligned allocation",
+          "[buddy allocator][alignment]")
+{
+    SECTION("empty allocators have dummy behaviour")
+    {
+        auto allocator = alc::BuddyAllocator{};
+
+        REQUIRE(allocator.allocate(1, 64) == nullptr);
+        REQUIRE_NOTHROW(allocator.deallocate(nullptr, 1, 64));
+    }
+
+    SECTION("alignments which are not powers of two are rejected")
+    {
+        auto allocator = alc::BuddyAllocator(memory, SIZE);
+
+        REQUIRE_THROWS_AS(allocator.allocate(1, 0), std::invalid_argument);
+        REQUIRE_THROWS_AS(allocator.allocate(1, 48), std::invalid_argument);
+    }
+
+    SECTION("blocks are aligned as requested")
+    {
+        // When the managed block is not aligned as requested, the pointers
+        // handed out are not at the start of the buddy blocks.
+        for (auto offset : { 0u, 1u, 80u })
+        {
+            const auto memory_block = memory + offset;
+            const auto size = SIZE - offset;
+            auto allocator = alc::BuddyAllocator(memory_block, size);
+            const auto initial_allocation =
+                allocate_memory_in_small_blocks(allocator);
+            deallocate(initial_allocation.blocks, allocator);
+            auto blocks = std::vector<void*>{};
+
+            for (auto alignment = std::size_t(1);
+                 alignment <= 512;
+                 alignment *= 2)
+            {
+                const auto block = allocator.allocate(100, alignment);
+                REQUIRE(is_valid_pointer(block, memory_block, size, alignment));
+                REQUIRE(is_within_memory_block(add_to(block, 99),
+                                               memory_block,
+                                               size));
+                blocks.push_back(block);
+            }
+
+            auto alignment = std::size_t(1);
+
+            for (auto block : blocks)
+            {
+                allocator.deallocate(block, 100, alignment);
+                alignment *= 2;
+            }
+
+            REQUIRE(allocate_memory_in_small_blocks(allocator).blocks ==
+                    initial_allocation.blocks);
+        }
+    }
+
+    SECTION("blocks as big as the alignment are not padded")
+    {
+        auto allocator = alc::BuddyAllocator(aligned_memory, SIZE);
+
+        const auto block = allocator.allocate(SIZE / 2, SIZE / 2);
+
+        REQUIRE(block != nullptr);
+        REQUIRE(is_correctly_aligned(block, SIZE / 2));
+        allocator.deallocate(block, SIZE / 2, SIZE / 2);
+    }
+
+    SECTION("requests which do not fit fail")
+    {
+        auto allocator = alc::BuddyAllocator(memory, SIZE);
+
+        REQUIRE(allocator.allocate(SIZE, 64) == nullptr);
+        REQUIRE(allocator.allocate(1, 2 * SIZE) == nullptr);
+    }
+
+}
+
+
+TEST_CASE("BuddyAllocator reallocation",
+          "[buddy allocator][reallocation]")
+{
+    // The managed block is aligned to its size, so the leaves in its upper
+    // half are the children of its right half in order. All of them are
+    // allocated up front and the sections free the ones they need.
+    constexpr auto LEAF_SIZE = std::size_t(128);
+    const auto leaf_at = [](std::size_t i) -> void*
+    {
+        return aligned_memory + SIZE / 2 + i * LEAF_SIZE;
+    };
+    auto allocator = alc::BuddyAllocator(aligned_memory, SIZE);
+    const auto initial_allocation = allocate_memory_in_small_blocks(allocator);
+    const auto deallocate_leaves = [&allocator, &leaf_at](
+        std::size_t begin,
+        std::size_t end)
+    {
+        for (auto i = begin; i < end; ++i)
+        {
+            allocator.deallocate(leaf_at(i), LEAF_SIZE);
+        }
+    };
+    const auto all_memory_is_free = [&allocator, &initial_allocation]()
+    {
+        for (auto block : initial_allocation.blocks)
+        {
+            if (block < aligned_memory + SIZE / 2)
+            {
+                allocator.deallocate(block);
+            }
+        }
+
+        return allocate_memory_in_small_blocks(allocator).blocks ==
+               initial_allocation.blocks;
+    };
+
+    SECTION("empty allocators have dummy behaviour")
+    {
+        auto empty = alc::BuddyAllocator{};
+
+        REQUIRE(empty.reallocate(nullptr, 0, 1) == nullptr);
+        REQUIRE(empty.reallocate(memory, 1, 2) == nullptr);
+        REQUIRE_FALSE(empty.try_expand_in_place(memory, 1, 2));
+    }
+
+    SECTION("blocks grow into their free right buddies")
+    {
+        deallocate_leaves(1, 2);
+        REQUIRE(allocator.try_expand_in_place(leaf_at(0),
+                                              LEAF_SIZE,
+                                              2 * LEAF_SIZE));
+
+        deallocate_leaves(2, 8);
+        REQUIRE(allocator.try_expand_in_place(leaf_at(0),
+                                              2 * LEAF_SIZE,
+                                              8 * LEAF_SIZE));
+
+        deallocate_leaves(8, 16);
+        allocator.deallocate(leaf_at(0));
+        REQUIRE(all_memory_is_free());
+    }
+
+    SECTION("blocks which are big enough already do not change")
+    {
+        REQUIRE(allocator.try_expand_in_place(leaf_at(0), 1, LEAF_SIZE));
+        REQUIRE(allocator.reallocate(leaf_at(0), 1, LEAF_SIZE) == leaf_at(0));
+
+        deallocate_leaves(0, 16);
+        REQUIRE(all_memory_is_free());
+    }
+
+    SECTION("right halves do not grow")
+    {
+        deallocate_leaves(0, 1);
+        REQUIRE_FALSE(allocator.try_expand_in_place(leaf_at(1),
+                                                    LEAF_SIZE,
+                                                    2 * LEAF_SIZE));
+
+        deallocate_leaves(1, 16);
+        REQUIRE(all_memory_is_free());
+    }
+
+    SECTION("allocated buddies prevent growth")
+    {
+        REQUIRE_FALSE(allocator.try_expand_in_place(leaf_at(2),
+                                                    LEAF_SIZE,
+                                                    2 * LEAF_SIZE));
+
+        deallocate_leaves(0, 16);
+        REQUIRE(all_memory_is_free());
+    }
+
+    SECTION("partly free buddies prevent growth and change nothing")
+    {
+        deallocate_leaves(1, 3);
+        REQUIRE_FALSE(allocator.try_expand_in_place(leaf_at(0),
+                                                    LEAF_SIZE,
+                                                    4 * LEAF_SIZE));
+        REQUIRE(allocator.try_expand_in_place(leaf_at(0),
+                                              LEAF_SIZE,
+                                              2 * LEAF_SIZE));
+
+        deallocate_leaves(3, 16);
+        allocator.deallocate(leaf_at(0), 2 * LEAF_SIZE);
+        REQUIRE(all_memory_is_free());
+    }
+
+    SECTION("blocks do not grow beyond the managed block")
+    {
+        deallocate_leaves(1, 16);
+        REQUIRE_FALSE(allocator.try_expand_in_place(leaf_at(0),
+                                                    LEAF_SIZE,
+                                                    2 * SIZE));
+        REQUIRE(allocator.reallocate(leaf_at(0), LEAF_SIZE, 2 * SIZE) ==
+                nullptr);
+
+        deallocate_leaves(0, 1);
+        REQUIRE(all_memory_is_free());
+    }
+
+    SECTION("shrinking frees the right halves")
+    {
+        deallocate_leaves(1, 8);
+        REQUIRE(allocator.try_expand_in_place(leaf_at(0),
+                                              LEAF_SIZE,
+                                              8 * LEAF_SIZE));
+
+        REQUIRE(allocator.reallocate(leaf_at(0), 8 * LEAF_SIZE, 1) ==
+                leaf_at(0));
+
+        const auto freed_leaves = allocate_memory_in_small_blocks(allocator);
+        REQUIRE(freed_leaves.blocks.size() == 7);
+
+        for (auto i = std::size_t(1); i < 8; ++i)
+        {
+            REQUIRE(freed_leaves.blocks.count(leaf_at(i)) == 1);
+        }
+
+        deallocate_leaves(0, 16);
+        REQUIRE(all_memory_is_free());
+    }
+
+    SECTION("blocks which cannot grow are moved")
+    {
+        deallocate_leaves(4, 8);
+        std::fill_n(static_cast<char*>(leaf_at(1)), LEAF_SIZE, 'x');
+
+        const auto block =
+            allocator.reallocate(leaf_at(1), LEAF_SIZE, 4 * LEAF_SIZE);
+
+        REQUIRE(block == leaf_at(4));
+        REQUIRE(std::all_of(static_cast<char*>(block),
+                            static_cast<char*>(block) + LEAF_SIZE,
+                            [](char c) { return c == 'x'; }));
+        REQUIRE(allocator.try_expand_in_place(leaf_at(0),
+                                              LEAF_SIZE,
+                                              2 * LEAF_SIZE));
+
+        allocator.deallocate(block, 4 * LEAF_SIZE);
+        allocator.deallocate(leaf_at(0), 2 * LEAF_SIZE);
+        deallocate_leaves(2, 4);
+        deallocate_leaves(8, 16);
+        REQUIRE(all_memory_is_free());
+    }
+
+    SECTION("blocks are left intact when they cannot be moved")
+    {
+        REQUIRE(allocator.reallocate(leaf_at(1), LEAF_SIZE, 4 * LEAF_SIZE) ==
+                nullptr);
+
+        deallocate_leaves(0, 16);
+        REQUIRE(all_memory_is_free());
+    }
+
+    SECTION("null pointers are allocated and zero sizes deallocate")
+    {
+        deallocate_leaves(1, 2);
+
+        REQUIRE(allocator.reallocate(nullptr, 0, LEAF_SIZE) == leaf_at(1));
+        REQUIRE(allocator.reallocate(leaf_at(1), LEAF_SIZE, 0) == nullptr);
+        REQUIRE(allocator.try_expand_in_place(leaf_at(0),
+                                              LEAF_SIZE,
+                                              2 * LEAF_SIZE));
+
+        allocator.deallocate(leaf_at(0));
+        deallocate_leaves(2, 16);
+        REQUIRE(all_memory_is_free());
+    }
+
+}
+
+
+TEST_CASE("BuddyAllocator reallocation with a level map",
+          "[buddy allocator][reallocation][level map]")
+{
+    auto allocator = alc::BuddyAllocator(aligned_memory,
+                                         SIZE,
+                                         alc::LevelLookup::level_map);
+    const auto initial_allocation = allocate_memory_in_small_blocks(allocator);
+    deallocate(initial_allocation.blocks, allocator);
+    const auto block = allocator.allocate(SIZE / 2);
+    REQUIRE(block != nullptr);
+
+    SECTION("shrunk blocks are deallocated at their new level")
+    {
+        REQUIRE(allocator.reallocate(block, SIZE / 2, 1) == block);
+        allocator.deallocate(block);
+    }
+
+    SECTION("grown blocks are deallocated at their new level")
+    {
+        REQUIRE(allocator.reallocate(block, SIZE / 2, SIZE / 8) == block);
+        REQUIRE(allocator.try_expand_in_place(block, SIZE / 8, SIZE / 2));
+        allocator.deallocate(block);
+    }
+
+    REQUIRE(allocate_memory_in_small_blocks(allocator).blocks ==
+            initial_allocation.blocks);
+}
+
+
+TEST_CASE("BuddyAllocator statistics",
+          "[buddy allocator][stats]")
+{
+    constexpr auto LEAF_SIZE = std::size_t(128);
+    auto allocator = alc::BuddyAllocatorWithStats(aligned_memory, SIZE);
+    const auto& stats = allocator.get_stats();
+    const auto initial_free_bytes = stats.free_bytes();
+    const auto initial_fragmentation = stats.fragmentation();
+
+    REQUIRE(stats.get_levels_count() == 6);
+    REQUIRE(stats.get_bytes_in_use() == 0);
+    REQUIRE(initial_free_bytes > SIZE / 2);
+    REQUIRE(initial_free_bytes < SIZE);
+
+    SECTION("allocation and deallocation")
+    {
+        // At most one free leaf is left after construction, so the second
+        // one is split off a bigger block.
+        const auto leaf = allocator.allocate(1);
+        const auto other_leaf = allocator.allocate(1);
+        const auto block = allocator.allocate(1000);
+
+        REQUIRE(stats.blocks_in_use_at(5) == 2);
+        REQUIRE(stats.blocks_in_use_at(2) == 1);
+        REQUIRE(stats.get_bytes_in_use() == 2 * LEAF_SIZE + 1024);
+        REQUIRE(stats.free_bytes() + stats.get_bytes_in_use() ==
+                initial_free_bytes);
+
+        allocator.deallocate(leaf);
+        allocator.deallocate(other_leaf, 1);
+        allocator.deallocate(block, 1000);
+
+        REQUIRE(stats.get_bytes_in_use() == 0);
+        REQUIRE(stats.get_peak_bytes_in_use() == 2 * LEAF_SIZE + 1024);
+        REQUIRE(stats.get_splits_count() > 0);
+        REQUIRE(stats.get_merges_count() == stats.get_splits_count());
+        REQUIRE(stats.free_bytes() == initial_free_bytes);
+        REQUIRE(stats.fragmentation() == initial_fragmentation);
+    }
+
+    SECTION("failed allocations")
+    {
+        REQUIRE(allocator.allocate(2 * SIZE) == nullptr);
+        REQUIRE(allocator.allocate(2 * SIZE, 64) == nullptr);
+        REQUIRE(allocator.allocate(SIZE) == nullptr);
+
+        REQUIRE(stats.get_failed_allocations_count() == 3);
+    }
+
+    SECTION("batches and reallocation")
+    {
+        void* blocks[4];
+        REQUIRE(allocator.allocate_n(1, 4, blocks) == 4);
+        REQUIRE(stats.blocks_in_use_at(5) == 4);
+
+        const auto block = allocator.reallocate(blocks[0], 1, 4 * LEAF_SIZE);
+        REQUIRE(stats.blocks_in_use_at(5) == 3);
+        REQUIRE(stats.blocks_in_use_at(3) == 1);
+
+        allocator.reallocate(block, 4 * LEAF_SIZE, 1);
+        REQUIRE(stats.blocks_in_use_at(5) == 4);
+        REQUIRE(stats.free_bytes() + stats.get_bytes_in_use() ==
+                initial_free_bytes);
+
+        blocks[0] = block;
+        allocator.deallocate_n(blocks, 4);
+
+        REQUIRE(stats.get_bytes_in_use() == 0);
+        REQUIRE(stats.free_bytes() == initial_free_bytes);
+    }
+
+    SECTION("shrinking in place returns the unused halves")
+    {
+        const auto block = allocator.allocate(1000);
+        REQUIRE(stats.blocks_in_use_at(2) == 1);
+
+        REQUIRE(allocator.try_expand_in_place(block, 1000, 100));
+        REQUIRE(stats.blocks_in_use_at(2) == 0);
+        REQUIRE(stats.blocks_in_use_at(5) == 1);
+        REQUIRE(stats.get_bytes_in_use() == LEAF_SIZE);
+        REQUIRE(stats.free_bytes() + stats.get_bytes_in_use() ==
+                initial_free_bytes);
+
+        allocator.deallocate(block, 100);
+
+        REQUIRE(stats.get_bytes_in_use() == 0);
+        REQUIRE(stats.free_bytes() == initial_free_bytes);
+        REQUIRE(allocator.allocate(SIZE / 2) != nullptr);
+    }
+
+    SECTION("fragmentation")
+    {
+        const auto leaves = allocate_memory_in_small_blocks(allocator);
+        REQUIRE(stats.free_bytes() == 0);
+
+        // Freeing every other leaf leaves no two free buddies to merge.
+        for (auto i = std::size_t(0); i < 8; ++i)
+        {
+            allocator.deallocate(aligned_memory + SIZE / 2 +
+                                 2 * i * LEAF_SIZE);
+        }
+
+        REQUIRE(stats.largest_free_block() == LEAF_SIZE);
+        REQUIRE(stats.fragmentation() == Approx(1.0 - 1.0 / 8));
+
+        for (auto i = std::size_t(0); i < 8; ++i)
+        {
+            allocator.deallocate(aligned_memory + SIZE / 2 +
+                                 (2 * i + 1) * LEAF_SIZE);
+        }
+
+        REQUIRE(stats.largest_free_block() == SIZE / 2);
+    }
+
+}
+
+
+TEST_CASE("BuddyAllocator exact allocation",
+          "[buddy allocator][exact allocation]")
+{
+    constexpr auto LEAF_SIZE = std::size_t(128);
+    auto allocator = alc::BuddyAllocatorWithStats(aligned_memory, SIZE);
+    const auto& stats = allocator.get_stats();
+    const auto initial_free_bytes = stats.free_bytes();
+
+    SECTION("zero bytes and too big requests fail")
+    {
+        REQUIRE(allocator.allocate_exact(0) == nullptr);
+        REQUIRE(allocator.allocate_exact(SIZE) == nullptr);
+        REQUIRE(allocator.allocate_exact(2 * SIZE) == nullptr);
+        REQUIRE(alc::BuddyAllocator{}.allocate_exact(1) == nullptr);
+
+        REQUIRE(stats.get_failed_allocations_count() == 2);
+    }
+
+    SECTION("a power of two takes a whole block")
+    {
+        const auto block = allocator.allocate_exact(4 * LEAF_SIZE);
+
+        REQUIRE(block != nullptr);
+        REQUIRE(stats.blocks_in_use_at(3) == 1);
+        REQUIRE(stats.get_bytes_in_use() == 4 * LEAF_SIZE);
+
+        allocator.deallocate_exact(block, 4 * LEAF_SIZE);
+        REQUIRE(stats.free_bytes() == initial_free_bytes);
+    }
+
+    SECTION("the unused tail of the block is freed")
+    {
+        // Nine leaves are taken out of a block of sixteen and the other
+        // seven are left as free blocks of four, two and one leaves.
+        const auto size = 8 * LEAF_SIZE + 1;
+        const auto block = allocator.allocate_exact(size);
+
+        REQUIRE(block == aligned_memory + SIZE / 2);
+        REQUIRE(stats.get_bytes_in_use() == 9 * LEAF_SIZE);
+        REQUIRE(stats.blocks_in_use_at(2) == 1);
+        REQUIRE(stats.blocks_in_use_at(5) == 1);
+        REQUIRE(stats.free_bytes() + stats.get_bytes_in_use() ==
+                initial_free_bytes);
+
+        REQUIRE(allocator.allocate(4 * LEAF_SIZE) ==
+                add_to(block, 12 * LEAF_SIZE));
+        REQUIRE(allocator.allocate(2 * LEAF_SIZE) ==
+                add_to(block, 10 * LEAF_SIZE));
+        REQUIRE(allocator.allocate(LEAF_SIZE) ==
+                add_to(block, 9 * LEAF_SIZE));
+
+        allocator.deallocate(add_to(block, 12 * LEAF_SIZE));
+        allocator.deallocate(add_to(block, 10 * LEAF_SIZE));
+        allocator.deallocate(add_to(block, 9 * LEAF_SIZE));
+        allocator.deallocate_exact(block, size);
+
+        REQUIRE(stats.get_bytes_in_use() == 0);
+        REQUIRE(stats.free_bytes() == initial_free_bytes);
+        REQUIRE(allocator.allocate(SIZE / 2) == block);
+    }
+
+    SECTION("random exact allocations keep blocks intact")
+    {
+        auto blocks = std::vector<std::pair<unsigned char*, std::size_t>>{};
+        auto intact = true;
+        auto seed = 3u;
+
+        for (auto i = 0; i < 5000; ++i)
+        {
+            seed = seed * 1103515245u + 12345u;
+            const auto size = std::size_t(seed >> 16) % (SIZE / 4) + 1;
+            const auto block =
+                static_cast<unsigned char*>(allocator.allocate_exact(size));
+
+            if (block != nullptr)
+            {
+                std::fill(block, block + size, (unsigned char)(size));
+                blocks.emplace_back(block, size);
+            }
+
+            if (!blocks.empty() && (block == nullptr || seed % 3 == 0))
+            {
+                const auto j = std::size_t(seed >> 8) % blocks.size();
+                const auto b = blocks[j];
+                intact = intact && std::all_of(
+                    b.first,
+                    b.first + b.second,
+                    [&b](auto c) { return c == (unsigned char)(b.second); }
+                );
+                allocator.deallocate_exact(b.first, b.second);
+                blocks[j] = blocks.back();
+                blocks.pop_back();
+            }
+        }
+
+        REQUIRE(intact);
+
+        for (const auto& b : blocks)
+        {
+            allocator.deallocate_exact(b.first, b.second);
+        }
+
+        REQUIRE(stats.get_bytes_in_use() == 0);
+        REQUIRE(stats.free_bytes() == initial_free_bytes);
+    }
+}
+
+
+#if defined(__VIRTUAL_MEMORY_AVAILABLE__)
+TEST_CASE("BuddyAllocator purging free memory",
+          "[buddy allocator][purge]")
+{
+    // Aligned to the biggest common page size, so that big free blocks
+    // span whole pages.
+    constexpr auto PURGED_SIZE = std::size_t(1) << 20;
+    alignas(1 << 16) static char purged_memory[PURGED_SIZE];
+    auto allocator = alc::BuddyAllocatorWithStats(purged_memory, PURGED_SIZE);
+    const auto& stats = allocator.get_stats();
+    const auto half = allocator.allocate(PURGED_SIZE / 2);
+    REQUIRE(half != nullptr);
+    std::fill(static_cast<char*>(half),
+              static_cast<char*>(half) + PURGED_SIZE / 2,
+              1);
+
+    SECTION("moves keep the threshold and the statistics")
+    {
+        allocator.set_purge_threshold(PURGED_SIZE / 2);
+        auto moved_into = std::move(allocator);
+        moved_into.deallocate(half);
+
+        REQUIRE(moved_into.get_purge_threshold() == PURGED_SIZE / 2);
+        REQUIRE(moved_into.get_stats().get_purged_bytes() > 0);
+        REQUIRE(moved_into.get_stats().get_bytes_in_use() == 0);
+    }
+
+    SECTION("nothing is purged by default")
+    {
+        allocator.deallocate(half);
+
+        REQUIRE(allocator.get_purge_threshold() == 0);
+        REQUIRE(stats.get_purged_bytes() == 0);
+    }
+
+    SECTION("blocks are purged when freed above the threshold")
+    {
+        allocator.set_purge_threshold(PURGED_SIZE / 2);
+        allocator.deallocate(half);
+
+        REQUIRE(stats.get_purged_bytes() > 0);
+        REQUIRE(stats.get_purged_bytes() < PURGED_SIZE / 2);
+        REQUIRE(stats.get_purged_bytes() % alc::page_size() == 0);
+    }
+
+    SECTION("blocks below the threshold are not purged")
+    {
+        allocator.set_purge_threshold(PURGED_SIZE);
+        allocator.deallocate(half);
+
+        REQUIRE(stats.get_purged_bytes() == 0);
+    }
+
+    SECTION("trim purges free blocks of at least the given size")
+    {
+        allocator.deallocate(half);
+
+        REQUIRE(allocator.trim(2 * PURGED_SIZE) == 0);
+        const auto purged = allocator.trim(PURGED_SIZE / 4);
+        REQUIRE(purged > 0);
+        REQUIRE(purged == stats.get_purged_bytes());
+        REQUIRE(allocator.trim() >= purged);
+    }
+
+    SECTION("free lists are intact after purging")
+    {
+        allocator.deallocate(half);
+        const auto expected_blocks =
+            allocate_memory_in_small_blocks(allocator).blocks;
+        deallocate(expected_blocks, allocator);
+
+        allocator.trim();
+
+        REQUIRE(allocate_memory_in_small_blocks(allocator).blocks ==
+                expected_blocks);
+    }
+
+}
+#endif
+
+
+TEST_CASE("BuddyAllocator batch allocation and deallocation",
+          "[buddy allocator][allocation][deallocation][batch]")
+{
+    const auto memory_block = memory + 1;
+    const auto size = SIZE - 1;
+    auto allocator = alc::BuddyAllocator(memory_block, size);
+    const auto initial_allocation =
+        allocate_memory_in_small_blocks(allocator);
+    const auto leaves_count = initial_allocation.blocks.size();
+    deallocate(initial_allocation.blocks, allocator);
+    auto blocks = std::vector<void*>(leaves_count + 1);
+
+    SECTION("empty allocators have dummy behaviour")
+    {
+        auto empty = alc::BuddyAllocator{};
+
+        REQUIRE(empty.allocate_n(1, 1, blocks.data()) == 0);
+        REQUIRE_NOTHROW(empty.deallocate_n(blocks.data(), 0));
+        REQUIRE_NOTHROW(empty.deallocate_n(blocks.data(), 0, 0));
+    }
+
+    SECTION("as many blocks as possible are allocated")
+    {
+        const auto allocated =
+            allocator.allocate_n(1, blocks.size(), blocks.data());
+
+        REQUIRE(allocated == leaves_count);
+        REQUIRE(std::unordered_set<void*>(blocks.begin(),
+                                          blocks.begin() + allocated) ==
+                initial_allocation.blocks);
+
+        allocator.deallocate_n(blocks.data(), allocated, 1);
+    }
+
+    SECTION("sized deallocation coalesces the whole batch")
+    {
+        const auto allocated =
+            allocator.allocate_n(1, blocks.size(), blocks.data());
+        std::reverse(blocks.begin(), blocks.begin() + allocated);
+
+        allocator.deallocate_n(blocks.data(), allocated, 1);
+
+        const auto big_block = allocator.allocate(size / 2);
+        REQUIRE(big_block != nullptr);
+        allocator.deallocate(big_block);
+        REQUIRE(allocate_memory_in_small_blocks(allocator).blocks ==
+                initial_allocation.blocks);
+    }
+
+    SECTION("unsized deallocation of blocks with different sizes")
+    {
+        auto count = std::size_t(0);
+
+        for (auto block_size : { 1u, 256u, 1u, 512u, 128u, 256u })
+        {
+            blocks[count] = allocator.allocate(block_size);
+            REQUIRE(blocks[count] != nullptr);
+            ++count;
+        }
+
+        blocks[count++] = nullptr;
+        std::swap(blocks[0], blocks[4]);
+
+        allocator.deallocate_n(blocks.data(), count);
+
+        const auto second_allocation =
+            allocate_memory_in_small_blocks(allocator);
+        REQUIRE(second_allocation.blocks == initial_allocation.blocks);
+        deallocate(second_allocation.blocks, allocator);
+    }
+
+}
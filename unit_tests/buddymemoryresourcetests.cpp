@@ -0,0 +1,132 @@
+#include "buddymemoryresource.hpp"
+
+#if defined(__BUDDY_MEMORY_RESOURCE_AVAILABLE__)
+
+#include <cstdint>
+#include <new>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "catch.hpp"
+
+namespace alc = allocator;
+
+
+constexpr auto SIZE = 1u << 16;
+alignas(std::max_align_t) static char memory[SIZE];
+
+
+bool is_aligned(void* p, std::size_t alignment)
+{
+    return reinterpret_cast<std::uintptr_t>(p) % alignment == 0;
+}
+
+
+std::size_t count_leaf_allocations(alc::BuddyMemoryResource& resource)
+{
+    auto blocks = std::vector<void*>{};
+
+    try
+    {
+        while (true)
+        {
+            blocks.push_back(resource.allocate(1));
+        }
+    }
+    catch (std::bad_alloc&)
+    {
+    }
+
+    for (auto block : blocks)
+    {
+        resource.deallocate(block, 1);
+    }
+
+    return blocks.size();
+}
+
+
+TEST_CASE("BuddyMemoryResource allocation and deallocation",
+          "[buddy memory resource]")
+{
+    auto resource = alc::BuddyMemoryResource(memory, SIZE);
+    const auto leaves_count = count_leaf_allocations(resource);
+
+    SECTION("empty resources throw bad_alloc")
+    {
+        auto empty = alc::BuddyMemoryResource{};
+
+        REQUIRE_FALSE(empty.manages_memory());
+        REQUIRE_THROWS_AS(empty.allocate(1), std::bad_alloc);
+    }
+
+    SECTION("exhausted resources throw bad_alloc")
+    {
+        REQUIRE_THROWS_AS(resource.allocate(2 * SIZE), std::bad_alloc);
+    }
+
+    SECTION("zero sized requests return a block")
+    {
+        const auto block = resource.allocate(0);
+
+        REQUIRE(block != nullptr);
+        resource.deallocate(block, 0);
+        REQUIRE(count_leaf_allocations(resource) == leaves_count);
+    }
+
+    SECTION("over-aligned requests")
+    {
+        auto blocks = std::vector<void*>{};
+
+        for (auto alignment = std::size_t(32);
+             alignment <= 4096;
+             alignment *= 2)
+        {
+            const auto block = resource.allocate(100, alignment);
+            REQUIRE(is_aligned(block, alignment));
+            blocks.push_back(block);
+        }
+
+        auto alignment = std::size_t(32);
+
+        for (auto block : blocks)
+        {
+            resource.deallocate(block, 100, alignment);
+            alignment *= 2;
+        }
+
+        REQUIRE(count_leaf_allocations(resource) == leaves_count);
+    }
+
+    SECTION("resources are only equal to themselves")
+    {
+        auto other = alc::BuddyMemoryResource{};
+
+        REQUIRE(resource == resource);
+        REQUIRE_FALSE(resource == other);
+    }
+
+    SECTION("pmr containers")
+    {
+        {
+            auto numbers = std::pmr::vector<int>(&resource);
+            auto names = std::pmr::unordered_map<int, std::pmr::string>(
+                &resource
+            );
+
+            for (auto i = 0; i < 100; ++i)
+            {
+                numbers.push_back(i);
+                names.emplace(i, std::to_string(i) + " is a long string");
+            }
+
+            REQUIRE(numbers.size() == 100);
+            REQUIRE(names.at(42) == "42 is a long string");
+        }
+
+        REQUIRE(count_leaf_allocations(resource) == leaves_count);
+    }
+}
+
+#endif
@@ -0,0 +1,103 @@
+#include <type_traits>
+
+#include "catch.hpp"
+
+#include "buddyallocator.hpp"
+#include "buddystats.hpp"
+
+namespace alc = allocator;
+
+
+TEST_CASE("NoStats records nothing", "[buddy stats]")
+{
+    REQUIRE(std::is_empty<alc::NoStats>::value);
+}
+
+
+TEST_CASE("Statistics take no space in an allocator beyond their own size",
+          "[buddy stats]")
+{
+    REQUIRE(sizeof(alc::BuddyAllocatorWithStats) ==
+            sizeof(alc::BuddyAllocator) + sizeof(alc::BuddyStats));
+}
+
+
+TEST_CASE("BuddyStats counters", "[buddy stats]")
+{
+    constexpr auto LEVELS_COUNT = std::size_t(4);
+    constexpr auto SIZE = std::size_t(1024);
+    auto stats = alc::BuddyStats{};
+    stats.record_creation(LEVELS_COUNT, SIZE);
+
+    SECTION("block sizes halve with each level")
+    {
+        REQUIRE(stats.get_levels_count() == LEVELS_COUNT);
+
+        for (auto i = std::size_t(0); i < LEVELS_COUNT; ++i)
+        {
+            REQUIRE(stats.block_size_at(i) == SIZE >> i);
+        }
+    }
+
+    SECTION("usage and peak usage")
+    {
+        stats.record_allocation(3);
+        stats.record_allocation(1);
+        stats.record_deallocation(1);
+        stats.record_allocation(3);
+
+        REQUIRE(stats.blocks_in_use_at(3) == 2);
+        REQUIRE(stats.bytes_in_use_at(3) == 256);
+        REQUIRE(stats.blocks_in_use_at(1) == 0);
+        REQUIRE(stats.get_bytes_in_use() == 256);
+        REQUIRE(stats.get_peak_bytes_in_use() == 128 + 512);
+    }
+
+    SECTION("free memory and fragmentation")
+    {
+        REQUIRE(stats.free_bytes() == 0);
+        REQUIRE(stats.largest_free_block() == 0);
+        REQUIRE(stats.fragmentation() == 0.0);
+
+        stats.record_insertion(1);
+        REQUIRE(stats.fragmentation() == 0.0);
+
+        stats.record_insertion(3);
+        stats.record_insertion(3);
+        stats.record_insertion(3);
+        stats.record_insertion(3);
+        REQUIRE(stats.free_blocks_at(3) == 4);
+        REQUIRE(stats.free_bytes() == 1024);
+        REQUIRE(stats.largest_free_block() == 512);
+        REQUIRE(stats.fragmentation() == Approx(0.5));
+
+        stats.record_removal(1);
+        REQUIRE(stats.largest_free_block() == 128);
+        REQUIRE(stats.fragmentation() == Approx(0.75));
+    }
+
+    SECTION("events")
+    {
+        stats.record_split();
+        stats.record_split();
+        stats.record_merge();
+        stats.record_failure();
+
+        REQUIRE(stats.get_splits_count() == 2);
+        REQUIRE(stats.get_merges_count() == 1);
+        REQUIRE(stats.get_failed_allocations_count() == 1);
+    }
+
+    SECTION("creation resets the counters")
+    {
+        stats.record_allocation(2);
+        stats.record_failure();
+
+        stats.record_creation(2, 256);
+
+        REQUIRE(stats.get_levels_count() == 2);
+        REQUIRE(stats.get_bytes_in_use() == 0);
+        REQUIRE(stats.get_peak_bytes_in_use() == 0);
+        REQUIRE(stats.get_failed_allocations_count() == 0);
+    }
+}
@@ -0,0 +1,394 @@
+#include <atomic>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "catch.hpp"
+
+#include "concurrentbuddyallocator.hpp"
+
+namespace alc = allocator;
+
+
+constexpr auto SIZE = 1u << 20;
+constexpr auto THREADS_COUNT = 8u;
+constexpr auto ITERATIONS_PER_THREAD = 20000u;
+constexpr auto MAX_LIVE_BLOCKS_PER_THREAD = 64u;
+constexpr auto MAX_BLOCK_SIZE = 4096u;
+alignas(std::max_align_t) static char memory[SIZE];
+
+
+struct Block
+{
+    unsigned char* address;
+    std::size_t size;
+};
+
+
+std::size_t count_leaf_allocations(alc::ConcurrentBuddyAllocator& allocator)
+{
+    auto blocks = std::vector<void*>{};
+
+    for (auto block = allocator.allocate(1);
+         block != nullptr;
+         block = allocator.allocate(1))
+    {
+        blocks.push_back(block);
+    }
+
+    for (auto block : blocks)
+    {
+        allocator.deallocate(block);
+    }
+
+    return blocks.size();
+}
+
+
+bool is_filled_with(const Block& block, unsigned char value)
+{
+    for (auto i = std::size_t(0); i < block.size; ++i)
+    {
+        if (block.address[i] != value)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+bool allocate_and_free_randomly(alc::ConcurrentBuddyAllocator& allocator,
+                                unsigned char id,
+                                bool exact = false)
+{
+    auto engine = std::mt19937{ id };
+    auto sizes = std::uniform_int_distribution<std::size_t>{
+        1, MAX_BLOCK_SIZE
+    };
+    auto live_blocks = std::vector<Block>{};
+    auto blocks_are_intact = true;
+
+    const auto free_block_at = [&](std::size_t i)
+    {
+        const auto block = live_blocks[i];
+        blocks_are_intact = blocks_are_intact && is_filled_with(block, id);
+
+        if (exact)
+        {
+            allocator.deallocate_exact(block.address, block.size);
+        }
+        else if (i % 2 == 0)
+        {
+            allocator.deallocate(block.address);
+        }
+        else
+        {
+            allocator.deallocate(block.address, block.size);
+        }
+
+        live_blocks[i] = live_blocks.back();
+        live_blocks.pop_back();
+    };
+
+    for (auto i = 0u; i < ITERATIONS_PER_THREAD; ++i)
+    {
+        if (live_blocks.size() < MAX_LIVE_BLOCKS_PER_THREAD &&
+            engine() % 3 != 0)
+        {
+            const auto size = sizes(engine);
+            const auto block = static_cast<unsigned char*>(
+                exact ? allocator.allocate_exact(size)
+                      : allocator.allocate(size)
+            );
+
+            if (block != nullptr)
+            {
+                std::memset(block, id, size);
+                live_blocks.push_back({ block, size });
+            }
+        }
+        else if (!live_blocks.empty())
+        {
+            free_block_at(engine() % live_blocks.size());
+        }
+    }
+
+    while (!live_blocks.empty())
+    {
+        free_block_at(live_blocks.size() - 1);
+    }
+
+    return blocks_are_intact;
+}
+
+
+TEST_CASE("ConcurrentBuddyAllocator special members",
+          "[concurrent buddy allocator][special members]")
+{
+    SECTION("default ctor creates an object that manages no memory")
+    {
+        const auto allocator = alc::ConcurrentBuddyAllocator{};
+
+        REQUIRE_FALSE(allocator.manages_memory());
+    }
+
+    SECTION("move ctor leaves source with no memory to manage")
+    {
+        auto source = alc::ConcurrentBuddyAllocator(memory, SIZE);
+
+        auto allocator = std::move(source);
+
+        REQUIRE_FALSE(source.manages_memory());
+        REQUIRE(allocator.manages_memory());
+
+        const auto p = allocator.allocate(1);
+        REQUIRE(p != nullptr);
+        allocator.deallocate(p);
+    }
+
+    SECTION("ctor with external metadata")
+    {
+        static char metadata[
+            alc::BuddyAllocator::required_metadata_size(SIZE)
+        ];
+        auto allocator = alc::ConcurrentBuddyAllocator(memory,
+                                                       SIZE,
+                                                       metadata,
+                                                       sizeof(metadata));
+
+        REQUIRE(allocator.manages_memory());
+        const auto p = allocator.allocate(1);
+        REQUIRE(p != nullptr);
+        allocator.deallocate(p);
+    }
+
+    SECTION("move assignment")
+    {
+        auto lhs = alc::ConcurrentBuddyAllocator{};
+        auto rhs = alc::ConcurrentBuddyAllocator(memory, SIZE);
+
+        lhs = std::move(rhs);
+
+        REQUIRE_FALSE(rhs.manages_memory());
+        REQUIRE(lhs.manages_memory());
+    }
+
+}
+
+
+TEST_CASE("ConcurrentBuddyAllocator allocation and deallocation",
+          "[concurrent buddy allocator][allocation][deallocation]")
+{
+    SECTION("empty allocators have dummy behaviour")
+    {
+        auto allocator = alc::ConcurrentBuddyAllocator{};
+
+        REQUIRE(allocator.allocate(1) == nullptr);
+        REQUIRE_NOTHROW(allocator.deallocate(nullptr));
+        REQUIRE_NOTHROW(allocator.deallocate(nullptr, 0));
+        REQUIRE(allocator.allocate_exact(1) == nullptr);
+        REQUIRE_NOTHROW(allocator.deallocate_exact(nullptr, 1));
+    }
+
+    SECTION("concurrent allocations and deallocations")
+    {
+        auto allocator = alc::ConcurrentBuddyAllocator(memory, SIZE);
+        const auto leaves_count = count_leaf_allocations(allocator);
+        auto threads = std::vector<std::thread>{};
+        bool blocks_are_intact[THREADS_COUNT] = {};
+
+        for (auto i = 0u; i < THREADS_COUNT; ++i)
+        {
+            threads.emplace_back(
+                [&allocator, &blocks_are_intact, i]()
+                {
+                    blocks_are_intact[i] = allocate_and_free_randomly(
+                        allocator,
+                        static_cast<unsigned char>(i + 1)
+                    );
+                }
+            );
+        }
+
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+
+        for (auto i = 0u; i < THREADS_COUNT; ++i)
+        {
+            CHECK(blocks_are_intact[i]);
+        }
+
+        REQUIRE(count_leaf_allocations(allocator) == leaves_count);
+        REQUIRE(allocator.allocate(SIZE / 2) != nullptr);
+    }
+
+    SECTION("concurrent allocations and deallocations with a level map")
+    {
+        auto allocator = alc::ConcurrentBuddyAllocator(
+            memory,
+            SIZE,
+            alc::LevelLookup::level_map
+        );
+        const auto leaves_count = count_leaf_allocations(allocator);
+        auto threads = std::vector<std::thread>{};
+        bool blocks_are_intact[THREADS_COUNT] = {};
+
+        for (auto i = 0u; i < THREADS_COUNT; ++i)
+        {
+            threads.emplace_back(
+                [&allocator, &blocks_are_intact, i]()
+                {
+                    blocks_are_intact[i] = allocate_and_free_randomly(
+                        allocator,
+                        static_cast<unsigned char>(i + 1)
+                    );
+                }
+            );
+        }
+
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+
+        for (auto i = 0u; i < THREADS_COUNT; ++i)
+        {
+            CHECK(blocks_are_intact[i]);
+        }
+
+        REQUIRE(count_leaf_allocations(allocator) == leaves_count);
+    }
+
+    SECTION("concurrent exact allocations and deallocations")
+    {
+        auto allocator = alc::ConcurrentBuddyAllocator(memory, SIZE);
+        const auto leaves_count = count_leaf_allocations(allocator);
+        auto threads = std::vector<std::thread>{};
+        bool blocks_are_intact[THREADS_COUNT] = {};
+
+        for (auto i = 0u; i < THREADS_COUNT; ++i)
+        {
+            threads.emplace_back(
+                [&allocator, &blocks_are_intact, i]()
+                {
+                    blocks_are_intact[i] = allocate_and_free_randomly(
+                        allocator,
+                        static_cast<unsigned char>(i + 1),
+                        true
+                    );
+                }
+            );
+        }
+
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+
+        for (auto i = 0u; i < THREADS_COUNT; ++i)
+        {
+            CHECK(blocks_are_intact[i]);
+        }
+
+        REQUIRE(count_leaf_allocations(allocator) == leaves_count);
+        REQUIRE(allocator.allocate(SIZE / 2) != nullptr);
+    }
+
+    SECTION("concurrent deallocations and trimming purge only free blocks")
+    {
+        auto allocator = alc::ConcurrentBuddyAllocator(memory, SIZE);
+        const auto leaves_count = count_leaf_allocations(allocator);
+        auto threads = std::vector<std::thread>{};
+        bool blocks_are_intact[THREADS_COUNT] = {};
+        std::atomic<bool> done{ false };
+        allocator.set_purge_threshold(4 * MAX_BLOCK_SIZE);
+
+        for (auto i = 0u; i < THREADS_COUNT; ++i)
+        {
+            threads.emplace_back(
+                [&allocator, &blocks_are_intact, i]()
+                {
+                    blocks_are_intact[i] = allocate_and_free_randomly(
+                        allocator,
+                        static_cast<unsigned char>(i + 1)
+                    );
+                }
+            );
+        }
+
+        auto trimmer = std::thread{
+            [&allocator, &done]()
+            {
+                while (!done.load())
+                {
+                    allocator.trim();
+                }
+            }
+        };
+
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+
+        done.store(true);
+        trimmer.join();
+
+        for (auto i = 0u; i < THREADS_COUNT; ++i)
+        {
+            CHECK(blocks_are_intact[i]);
+        }
+
+        REQUIRE(count_leaf_allocations(allocator) == leaves_count);
+    }
+
+}
+
+
+TEST_CASE("ConcurrentBuddyAllocator batch allocation and deallocation",
+          "[concurrent buddy allocator][batch]")
+{
+    constexpr auto BATCH_SIZE = 32u;
+    constexpr auto ROUNDS = 500u;
+    auto allocator = alc::ConcurrentBuddyAllocator(memory, SIZE);
+    const auto leaves_count = count_leaf_allocations(allocator);
+    auto threads = std::vector<std::thread>{};
+
+    for (auto i = 0u; i < THREADS_COUNT; ++i)
+    {
+        threads.emplace_back(
+            [&allocator, i]()
+            {
+                void* blocks[BATCH_SIZE];
+                const auto size = std::size_t(1) << (i % 4 + 5);
+
+                for (auto round = 0u; round < ROUNDS; ++round)
+                {
+                    const auto allocated =
+                        allocator.allocate_n(size, BATCH_SIZE, blocks);
+
+                    if (round % 2 == 0)
+                    {
+                        allocator.deallocate_n(blocks, allocated, size);
+                    }
+                    else
+                    {
+                        allocator.deallocate_n(blocks, allocated);
+                    }
+                }
+            }
+        );
+    }
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    REQUIRE(count_leaf_allocations(allocator) == leaves_count);
+}
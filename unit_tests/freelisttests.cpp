@@ -1,3 +1,6 @@
+#include <cstring>
+#include <new>
+
 #include "catch.hpp"
 
 #include "freelist.hpp"
@@ -184,3 +187,39 @@ TEST_CASE("FreeList size related methods", "[free list][size]")
     REQUIRE(list.is_empty());
     REQUIRE(list.get_size() == 0);
 }
+
+
+TEST_CASE("FreeList relocation", "[free list][relocation]")
+{
+    // A list stored next to its blocks, copied byte by byte elsewhere, as
+    // happens when memory is mapped at different addresses.
+    struct Region
+    {
+        FreeList list;
+        alignas(std::max_align_t) char blocks[BLOCKS_COUNT * BLOCK_SIZE];
+    };
+
+    static Region original;
+    static Region copy;
+    new (&original.list) FreeList{};
+
+    for (auto i = 0u; i < BLOCKS_COUNT; ++i)
+    {
+        original.list.insert(original.blocks + i * BLOCK_SIZE);
+    }
+
+    original.list.remove(original.blocks + BLOCK_SIZE);
+    std::memcpy(static_cast<void*>(&copy), &original, sizeof(Region));
+
+    REQUIRE(copy.list.get_size() == BLOCKS_COUNT - 1);
+
+    for (auto i = BLOCKS_COUNT; i-- > 0;)
+    {
+        if (i != 1)
+        {
+            REQUIRE(copy.list.extract() == copy.blocks + i * BLOCK_SIZE);
+        }
+    }
+
+    REQUIRE(copy.list.is_empty());
+}
@@ -0,0 +1,198 @@
+#include "growablebuddyheap.hpp"
+
+#if defined(__GROWABLE_BUDDY_HEAP_AVAILABLE__)
+
+#include <cstring>
+#include <stdexcept>
+#include <unordered_set>
+#include <vector>
+
+#include "catch.hpp"
+
+namespace alc = allocator;
+
+
+constexpr auto CHUNK_SIZE = std::size_t(1) << 16;
+constexpr auto CHUNKS_COUNT = std::size_t(4);
+
+
+std::vector<void*> allocate_until_exhausted(alc::GrowableBuddyHeap& heap,
+                                            std::size_t size)
+{
+    auto result = std::vector<void*>{};
+
+    while (const auto block = heap.allocate(size))
+    {
+        std::memset(block, 0xAB, size);
+        result.push_back(block);
+    }
+
+    return result;
+}
+
+
+TEST_CASE("GrowableBuddyHeap special members",
+          "[growable buddy heap][special members]")
+{
+    SECTION("default ctor creates an empty heap")
+    {
+        auto heap = alc::GrowableBuddyHeap{};
+
+        REQUIRE_FALSE(heap.manages_memory());
+        REQUIRE(heap.allocate(1) == nullptr);
+        REQUIRE_NOTHROW(heap.deallocate(nullptr));
+    }
+
+    SECTION("ctor throws for invalid configuration")
+    {
+        REQUIRE_THROWS_AS(alc::GrowableBuddyHeap(CHUNK_SIZE + 1),
+                          std::invalid_argument);
+        REQUIRE_THROWS_AS(alc::GrowableBuddyHeap(alc::page_size() / 2),
+                          std::invalid_argument);
+        REQUIRE_THROWS_AS(alc::GrowableBuddyHeap(CHUNK_SIZE, 0),
+                          std::invalid_argument);
+    }
+
+    SECTION("no chunk is committed up front")
+    {
+        const auto heap = alc::GrowableBuddyHeap(CHUNK_SIZE, CHUNKS_COUNT);
+
+        REQUIRE(heap.manages_memory());
+        REQUIRE(heap.committed_chunks_count() == 0);
+        REQUIRE(heap.get_chunk_size() == CHUNK_SIZE);
+        REQUIRE(heap.get_max_chunks_count() == CHUNKS_COUNT);
+    }
+
+    SECTION("move ctor empties source")
+    {
+        auto source = alc::GrowableBuddyHeap(CHUNK_SIZE, CHUNKS_COUNT);
+        const auto block = source.allocate(1);
+
+        auto heap = std::move(source);
+
+        REQUIRE_FALSE(source.manages_memory());
+        REQUIRE(heap.owns(block));
+        heap.deallocate(block);
+    }
+
+}
+
+
+TEST_CASE("GrowableBuddyHeap allocation and deallocation",
+          "[growable buddy heap][allocation][deallocation]")
+{
+    auto heap = alc::GrowableBuddyHeap(CHUNK_SIZE, CHUNKS_COUNT);
+
+    SECTION("chunks are committed on demand")
+    {
+        const auto block = heap.allocate(1);
+
+        REQUIRE(block != nullptr);
+        REQUIRE(heap.owns(block));
+        REQUIRE(heap.committed_chunks_count() == 1);
+        heap.deallocate(block);
+    }
+
+    SECTION("blocks bigger than half a chunk can't be allocated")
+    {
+        REQUIRE(heap.allocate(heap.max_block_size() + 1) == nullptr);
+        REQUIRE(heap.committed_chunks_count() == 0);
+    }
+
+    SECTION("the heap grows up to the maximum number of chunks")
+    {
+        const auto blocks =
+            allocate_until_exhausted(heap, heap.max_block_size());
+
+        REQUIRE(blocks.size() == CHUNKS_COUNT);
+        REQUIRE(heap.committed_chunks_count() == CHUNKS_COUNT);
+
+        for (auto block : blocks)
+        {
+            heap.deallocate(block, heap.max_block_size());
+        }
+    }
+
+    SECTION("blocks from all chunks are distinct and owned by the heap")
+    {
+        const auto blocks = allocate_until_exhausted(heap, 1);
+        const auto unique_blocks =
+            std::unordered_set<void*>(blocks.begin(), blocks.end());
+
+        REQUIRE(heap.committed_chunks_count() == CHUNKS_COUNT);
+        REQUIRE(unique_blocks.size() == blocks.size());
+
+        for (auto block : blocks)
+        {
+            REQUIRE(heap.owns(block));
+            heap.deallocate(block);
+        }
+    }
+
+    SECTION("free chunks are released, keeping a single spare one")
+    {
+        const auto blocks =
+            allocate_until_exhausted(heap, heap.max_block_size());
+
+        for (auto block : blocks)
+        {
+            heap.deallocate(block);
+        }
+
+        REQUIRE(heap.committed_chunks_count() == 1);
+        heap.release_free_chunks();
+        REQUIRE(heap.committed_chunks_count() == 0);
+    }
+
+    SECTION("released chunks can be committed again")
+    {
+        for (auto i = 0; i < 2; ++i)
+        {
+            const auto blocks = allocate_until_exhausted(heap, 1000);
+            REQUIRE_FALSE(blocks.empty());
+
+            for (auto block : blocks)
+            {
+                heap.deallocate(block, 1000);
+            }
+
+            heap.release_free_chunks();
+            REQUIRE(heap.committed_chunks_count() == 0);
+        }
+    }
+
+    SECTION("addresses outside the reservation are not owned")
+    {
+        auto local = 0;
+
+        REQUIRE_FALSE(heap.owns(&local));
+    }
+
+}
+
+
+TEST_CASE("GrowableBuddyHeap with a level map",
+          "[growable buddy heap][level map]")
+{
+    auto heap = alc::GrowableBuddyHeap(CHUNK_SIZE,
+                                       CHUNKS_COUNT,
+                                       alc::LevelLookup::level_map);
+    auto blocks = std::vector<void*>{};
+
+    for (auto size : { 1u, 4096u, 300u, 32768u, 128u, 32768u, 20000u })
+    {
+        blocks.push_back(heap.allocate(size));
+        REQUIRE(blocks.back() != nullptr);
+    }
+
+    REQUIRE(heap.committed_chunks_count() > 1);
+
+    for (auto block : blocks)
+    {
+        heap.deallocate(block);
+    }
+
+    REQUIRE(heap.committed_chunks_count() == 1);
+}
+
+#endif
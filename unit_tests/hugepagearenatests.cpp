@@ -0,0 +1,106 @@
+#include "hugepagearena.hpp"
+
+#if defined(__HUGE_PAGE_ARENA_AVAILABLE__)
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+#include "catch.hpp"
+
+namespace alc = allocator;
+
+
+bool is_aligned_to_huge_page(void* p)
+{
+    return reinterpret_cast<std::uintptr_t>(p) % alc::HUGE_PAGE_SIZE == 0;
+}
+
+
+TEST_CASE("HugePageArena special members",
+          "[huge page arena][special members]")
+{
+    SECTION("default ctor creates an arena with no memory")
+    {
+        const auto arena = alc::HugePageArena{};
+
+        REQUIRE_FALSE(arena.manages_memory());
+        REQUIRE_FALSE(arena.get_allocator().manages_memory());
+    }
+
+    SECTION("ctor throws for an empty arena")
+    {
+        REQUIRE_THROWS_AS(alc::HugePageArena(0), std::invalid_argument);
+    }
+
+    SECTION("the size is rounded up to whole huge pages")
+    {
+        const auto arena = alc::HugePageArena(alc::HUGE_PAGE_SIZE + 1,
+                                              alc::HugePages::none);
+
+        REQUIRE(arena.manages_memory());
+        REQUIRE(arena.get_size() == 2 * alc::HUGE_PAGE_SIZE);
+        REQUIRE(arena.get_pages() == alc::HugePages::none);
+        REQUIRE(arena.get_allocator().manages_memory());
+    }
+
+    SECTION("move ctor empties source")
+    {
+        auto source = alc::HugePageArena(alc::HUGE_PAGE_SIZE,
+                                         alc::HugePages::none);
+
+        const auto arena = std::move(source);
+
+        REQUIRE_FALSE(source.manages_memory());
+        REQUIRE(arena.manages_memory());
+        REQUIRE(arena.get_allocator().manages_memory());
+    }
+
+}
+
+
+TEST_CASE("HugePageArena allocation",
+          "[huge page arena][allocation]")
+{
+    SECTION("blocks of a huge page are aligned to a huge page")
+    {
+        // The logical size is 8 huge pages, so the logical start is two
+        // huge pages before the mapping.
+        auto arena = alc::HugePageArena(6 * alc::HUGE_PAGE_SIZE,
+                                        alc::HugePages::none);
+        auto& allocator = arena.get_allocator();
+
+        for (auto i = 0; i < 4; ++i)
+        {
+            const auto block = allocator.allocate(alc::HUGE_PAGE_SIZE);
+            REQUIRE(block != nullptr);
+            REQUIRE(is_aligned_to_huge_page(block));
+        }
+    }
+
+    SECTION("the arena falls back to whatever pages are available")
+    {
+        for (auto preferred : { alc::HugePages::huge_tlb,
+                                alc::HugePages::transparent })
+        {
+            auto arena = alc::HugePageArena(4 * alc::HUGE_PAGE_SIZE,
+                                            preferred);
+            auto& allocator = arena.get_allocator();
+            const auto block = allocator.allocate(alc::HUGE_PAGE_SIZE);
+
+            REQUIRE(block != nullptr);
+            REQUIRE(is_aligned_to_huge_page(block));
+            std::memset(block, 1, alc::HUGE_PAGE_SIZE);
+
+            if (preferred == alc::HugePages::transparent)
+            {
+                REQUIRE(arena.get_pages() != alc::HugePages::huge_tlb);
+            }
+
+            allocator.deallocate(block);
+        }
+    }
+
+}
+
+#endif
@@ -0,0 +1,202 @@
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "catch.hpp"
+
+#include "magazinecache.hpp"
+
+namespace alc = allocator;
+
+
+constexpr auto SIZE = 1u << 16;
+constexpr auto LEAF_SIZE = 128u;
+alignas(std::max_align_t) static char memory[SIZE];
+
+
+TEST_CASE("MagazineCache special members",
+          "[magazine cache][special members]")
+{
+    auto allocator = alc::ConcurrentBuddyAllocator(memory, SIZE);
+
+    SECTION("default ctor creates a detached cache")
+    {
+        auto cache = alc::MagazineCache{};
+
+        REQUIRE_FALSE(cache.is_attached());
+        REQUIRE(cache.allocate(1) == nullptr);
+        REQUIRE_NOTHROW(cache.deallocate(nullptr));
+    }
+
+    SECTION("ctor throws for invalid configuration")
+    {
+        REQUIRE_THROWS_AS(alc::MagazineCache(allocator, 0),
+                          std::invalid_argument);
+        REQUIRE_THROWS_AS(alc::MagazineCache(allocator, 8, 0),
+                          std::invalid_argument);
+        REQUIRE_THROWS_AS(
+            alc::MagazineCache(allocator,
+                               8,
+                               alc::MagazineCache::MAX_CACHED_LEVELS + 1),
+            std::invalid_argument
+        );
+    }
+
+    SECTION("a cache over an empty allocator is detached")
+    {
+        auto empty = alc::ConcurrentBuddyAllocator{};
+
+        REQUIRE_FALSE(alc::MagazineCache(empty).is_attached());
+    }
+
+    SECTION("move ctor detaches source")
+    {
+        auto source = alc::MagazineCache(allocator);
+
+        const auto cache = std::move(source);
+
+        REQUIRE_FALSE(source.is_attached());
+        REQUIRE(cache.is_attached());
+    }
+
+}
+
+
+TEST_CASE("MagazineCache allocation and deallocation",
+          "[magazine cache][allocation][deallocation]")
+{
+    constexpr auto CAPACITY = 8u;
+    auto allocator = alc::ConcurrentBuddyAllocator(memory, SIZE);
+
+    SECTION("first allocation refills the magazine with half its capacity")
+    {
+        auto cache = alc::MagazineCache(allocator, CAPACITY);
+        auto blocks = std::vector<void*>{};
+
+        for (auto i = 0u; i < CAPACITY / 2; ++i)
+        {
+            blocks.push_back(cache.allocate(LEAF_SIZE));
+            REQUIRE(blocks.back() != nullptr);
+        }
+
+        const auto& statistics = cache.get_statistics();
+        CHECK(statistics.misses == 1);
+        CHECK(statistics.hits == CAPACITY / 2 - 1);
+        CHECK(statistics.refills == 1);
+
+        for (auto block : blocks)
+        {
+            cache.deallocate(block, LEAF_SIZE);
+        }
+    }
+
+    SECTION("freed blocks are reused without going to the allocator")
+    {
+        auto cache = alc::MagazineCache(allocator, CAPACITY);
+
+        const auto block = cache.allocate(1);
+        cache.deallocate(block);
+
+        REQUIRE(cache.allocate(1) == block);
+        CHECK(cache.get_statistics().hits == 1);
+        cache.deallocate(block, 1);
+    }
+
+    SECTION("a full magazine is drained in a batch")
+    {
+        auto cache = alc::MagazineCache(allocator, CAPACITY);
+        auto blocks = std::vector<void*>{};
+
+        for (auto i = 0u; i <= CAPACITY; ++i)
+        {
+            blocks.push_back(allocator.allocate(1));
+        }
+
+        for (auto block : blocks)
+        {
+            cache.deallocate(block);
+        }
+
+        CHECK(cache.get_statistics().drains == 1);
+    }
+
+    SECTION("only the configured levels are cached")
+    {
+        auto cache = alc::MagazineCache(allocator, CAPACITY, 2);
+
+        const auto block = cache.allocate(4 * LEAF_SIZE);
+        cache.deallocate(block);
+        cache.allocate(2 * LEAF_SIZE);
+
+        CHECK(cache.get_statistics().misses == 1);
+    }
+
+    SECTION("flushing returns all cached blocks to the allocator")
+    {
+        auto cache = alc::MagazineCache(allocator,
+                                        CAPACITY,
+                                        alc::MagazineCache::MAX_CACHED_LEVELS);
+
+        for (auto size : { 1u, 2 * LEAF_SIZE, 4 * LEAF_SIZE })
+        {
+            cache.deallocate(cache.allocate(size), size);
+        }
+
+        cache.flush();
+
+        REQUIRE(allocator.allocate(SIZE / 2) != nullptr);
+    }
+
+    SECTION("destruction returns all cached blocks to the allocator")
+    {
+        {
+            auto cache = alc::MagazineCache(allocator, CAPACITY);
+            cache.deallocate(cache.allocate(1));
+        }
+
+        REQUIRE(allocator.allocate(SIZE / 2) != nullptr);
+    }
+
+}
+
+
+TEST_CASE("MagazineCache per thread",
+          "[magazine cache][concurrency]")
+{
+    constexpr auto THREADS_COUNT = 4u;
+    constexpr auto ROUNDS = 2000u;
+    constexpr auto BLOCKS_PER_ROUND = 12u;
+    auto allocator = alc::ConcurrentBuddyAllocator(memory, SIZE);
+    auto threads = std::vector<std::thread>{};
+
+    for (auto i = 0u; i < THREADS_COUNT; ++i)
+    {
+        threads.emplace_back(
+            [&allocator]()
+            {
+                auto cache = alc::MagazineCache(allocator, 16, 2);
+                void* blocks[BLOCKS_PER_ROUND];
+
+                for (auto round = 0u; round < ROUNDS; ++round)
+                {
+                    for (auto j = 0u; j < BLOCKS_PER_ROUND; ++j)
+                    {
+                        blocks[j] = cache.allocate(1 + j % 2 * LEAF_SIZE);
+                    }
+
+                    for (auto block : blocks)
+                    {
+                        cache.deallocate(block);
+                    }
+                }
+            }
+        );
+    }
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    REQUIRE(allocator.allocate(SIZE / 2) != nullptr);
+}
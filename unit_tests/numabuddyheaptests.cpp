@@ -0,0 +1,155 @@
+#include "numabuddyheap.hpp"
+
+#if defined(__NUMA_BUDDY_HEAP_AVAILABLE__)
+
+#include <stdexcept>
+#include <vector>
+
+#include "catch.hpp"
+
+namespace alc = allocator;
+
+
+namespace
+{
+    const std::size_t ARENA_SIZE = 1 << 20;
+    const std::size_t NODES_COUNT = 3;
+}
+
+
+TEST_CASE("NUMA helpers", "[numa buddy heap][numa]")
+{
+    SECTION("there is at least one node")
+    {
+        REQUIRE(alc::numa_nodes_count() >= 1);
+    }
+
+    SECTION("the current node is one of the nodes")
+    {
+        REQUIRE(alc::current_numa_node() < alc::numa_nodes_count());
+    }
+}
+
+
+TEST_CASE("NumaBuddyHeap special members",
+          "[numa buddy heap][special members]")
+{
+    SECTION("default ctor creates a heap with no memory")
+    {
+        auto heap = alc::NumaBuddyHeap{};
+
+        REQUIRE_FALSE(heap.manages_memory());
+        REQUIRE(heap.get_nodes_count() == 0);
+        REQUIRE(heap.allocate(1) == nullptr);
+    }
+
+    SECTION("ctor throws for an empty arena or no nodes")
+    {
+        REQUIRE_THROWS_AS(alc::NumaBuddyHeap(0), std::invalid_argument);
+        REQUIRE_THROWS_AS(alc::NumaBuddyHeap(ARENA_SIZE, 0),
+                          std::invalid_argument);
+    }
+
+    SECTION("the arena size is rounded up to whole pages")
+    {
+        const auto heap = alc::NumaBuddyHeap(alc::page_size() + 1, 2);
+
+        REQUIRE(heap.manages_memory());
+        REQUIRE(heap.get_arena_size() == 2 * alc::page_size());
+        REQUIRE(heap.get_nodes_count() == 2);
+    }
+
+    SECTION("by default there is an arena per node of the machine")
+    {
+        const auto heap = alc::NumaBuddyHeap(ARENA_SIZE);
+
+        REQUIRE(heap.get_nodes_count() == alc::numa_nodes_count());
+        REQUIRE(heap.get_bound_nodes_count() <= heap.get_nodes_count());
+    }
+
+    SECTION("move ctor empties source")
+    {
+        auto source = alc::NumaBuddyHeap(ARENA_SIZE, NODES_COUNT);
+        const auto block = source.allocate(100, 1);
+
+        auto heap = std::move(source);
+
+        REQUIRE_FALSE(source.manages_memory());
+        REQUIRE_FALSE(source.owns(block));
+        REQUIRE(heap.manages_memory());
+        REQUIRE(heap.owns(block));
+        heap.deallocate(block);
+    }
+}
+
+
+TEST_CASE("NumaBuddyHeap allocation", "[numa buddy heap][allocation]")
+{
+    auto heap = alc::NumaBuddyHeap(ARENA_SIZE, NODES_COUNT);
+
+    SECTION("blocks come from the arena of the requested node")
+    {
+        for (auto node = std::size_t(0); node < NODES_COUNT; ++node)
+        {
+            const auto block = heap.allocate(1000, node);
+
+            REQUIRE(block != nullptr);
+            REQUIRE(heap.owns(block));
+            REQUIRE(heap.node_of(block) == node);
+            heap.deallocate(block, 1000);
+        }
+    }
+
+    SECTION("nodes beyond the arenas wrap around")
+    {
+        const auto block = heap.allocate(1000, NODES_COUNT + 1);
+
+        REQUIRE(heap.node_of(block) == 1);
+        heap.deallocate(block);
+    }
+
+    SECTION("blocks of the calling thread's node are owned by the heap")
+    {
+        const auto block = heap.allocate(1000);
+
+        REQUIRE(heap.owns(block));
+        heap.deallocate(block);
+    }
+
+    SECTION("other nodes are used once a node is exhausted")
+    {
+        auto blocks = std::vector<void*>{};
+
+        while (const auto block = heap.allocate(1024, 0))
+        {
+            blocks.push_back(block);
+        }
+
+        REQUIRE(blocks.size() > NODES_COUNT * (ARENA_SIZE / 1024) / 2);
+        REQUIRE(heap.node_of(blocks.front()) == 0);
+        REQUIRE(heap.node_of(blocks.back()) != 0);
+
+        for (const auto block : blocks)
+        {
+            heap.deallocate(block, 1024);
+        }
+
+        // Every block went back to its own arena.
+        for (auto node = std::size_t(0); node < NODES_COUNT; ++node)
+        {
+            const auto block = heap.allocate(ARENA_SIZE / 4, node);
+
+            REQUIRE(heap.node_of(block) == node);
+        }
+    }
+
+    SECTION("memory outside the heap is not owned")
+    {
+        auto variable = 0;
+
+        REQUIRE_FALSE(heap.owns(&variable));
+        REQUIRE_FALSE(heap.owns(nullptr));
+    }
+}
+
+#endif
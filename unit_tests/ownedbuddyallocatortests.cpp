@@ -0,0 +1,278 @@
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "catch.hpp"
+
+#include "ownedbuddyallocator.hpp"
+
+namespace alc = allocator;
+
+
+namespace
+{
+    constexpr auto OWNED_SIZE = 1u << 20;
+    alignas(std::max_align_t) char owned_memory[OWNED_SIZE];
+
+
+    std::size_t count_owned_leaves(alc::OwnedBuddyAllocator& allocator)
+    {
+        auto blocks = std::vector<void*>{};
+
+        while (const auto block = allocator.allocate(1))
+        {
+            blocks.push_back(block);
+        }
+
+        for (const auto block : blocks)
+        {
+            allocator.deallocate(block);
+        }
+
+        return blocks.size();
+    }
+}
+
+
+TEST_CASE("OwnedBuddyAllocator special members",
+          "[owned buddy allocator][special members]")
+{
+    SECTION("default ctor creates an object that manages no memory")
+    {
+        auto allocator = alc::OwnedBuddyAllocator{};
+
+        REQUIRE_FALSE(allocator.manages_memory());
+        REQUIRE(allocator.is_owned_by_current_thread());
+        REQUIRE_FALSE(allocator.has_remote_frees());
+        REQUIRE(allocator.allocate(1) == nullptr);
+    }
+
+    SECTION("the creating thread owns the allocator")
+    {
+        const auto allocator =
+            alc::OwnedBuddyAllocator(owned_memory, OWNED_SIZE);
+        auto owned_elsewhere = true;
+
+        std::thread{ [&allocator, &owned_elsewhere]()
+        {
+            owned_elsewhere = allocator.is_owned_by_current_thread();
+        } }.join();
+
+        REQUIRE(allocator.manages_memory());
+        REQUIRE(allocator.is_owned_by_current_thread());
+        REQUIRE_FALSE(owned_elsewhere);
+    }
+
+    SECTION("move ctor takes the pending remote frees")
+    {
+        auto source = alc::OwnedBuddyAllocator(owned_memory, OWNED_SIZE);
+        const auto block = source.allocate(100);
+        std::thread{ [&source, block]()
+        {
+            source.deallocate(block);
+        } }.join();
+
+        auto allocator = std::move(source);
+
+        REQUIRE_FALSE(source.manages_memory());
+        REQUIRE_FALSE(source.has_remote_frees());
+        REQUIRE(allocator.has_remote_frees());
+        REQUIRE(allocator.drain_remote_frees() == 1);
+    }
+}
+
+
+TEST_CASE("OwnedBuddyAllocator remote frees",
+          "[owned buddy allocator][deallocation]")
+{
+    auto allocator = alc::OwnedBuddyAllocator(owned_memory, OWNED_SIZE);
+    const auto leaves_count = count_owned_leaves(allocator);
+
+    SECTION("the owner frees blocks directly")
+    {
+        const auto block = allocator.allocate(100);
+
+        allocator.deallocate(block);
+
+        REQUIRE_FALSE(allocator.has_remote_frees());
+        REQUIRE(count_owned_leaves(allocator) == leaves_count);
+    }
+
+    SECTION("other threads queue blocks until the owner allocates")
+    {
+        auto blocks = std::vector<void*>{};
+
+        for (auto i = 0; i < 10; ++i)
+        {
+            blocks.push_back(allocator.allocate(i % 2 == 0 ? 100 : 1000));
+        }
+
+        std::thread{ [&allocator, &blocks]()
+        {
+            for (auto i = std::size_t(0); i < blocks.size(); ++i)
+            {
+                if (i % 2 == 0)
+                {
+                    allocator.deallocate(blocks[i]);
+                }
+                else
+                {
+                    allocator.deallocate(blocks[i], 1000);
+                }
+            }
+        } }.join();
+
+        REQUIRE(allocator.has_remote_frees());
+
+        const auto block = allocator.allocate(1);
+
+        REQUIRE_FALSE(allocator.has_remote_frees());
+        allocator.deallocate(block);
+        REQUIRE(count_owned_leaves(allocator) == leaves_count);
+    }
+
+    SECTION("draining reports the number of blocks returned")
+    {
+        const auto first = allocator.allocate(100);
+        const auto second = allocator.allocate(100);
+
+        std::thread{ [&allocator, first, second]()
+        {
+            allocator.deallocate(first, 100);
+            allocator.deallocate(second, 100);
+        } }.join();
+
+        REQUIRE(allocator.drain_remote_frees() == 2);
+        REQUIRE(allocator.drain_remote_frees() == 0);
+    }
+
+    SECTION("remote frees spanning several batches are merged")
+    {
+        constexpr auto BLOCKS_COUNT = std::size_t(200);
+        auto blocks = std::vector<void*>{};
+
+        for (auto i = std::size_t(0); i < BLOCKS_COUNT; ++i)
+        {
+            blocks.push_back(allocator.allocate(i % 3 == 0 ? 1 : 300));
+        }
+
+        std::thread{ [&allocator, &blocks]()
+        {
+            for (auto i = std::size_t(0); i < blocks.size(); ++i)
+            {
+                if (i % 2 == 0)
+                {
+                    allocator.deallocate(blocks[i]);
+                }
+                else
+                {
+                    allocator.deallocate(blocks[i], i % 3 == 0 ? 1 : 300);
+                }
+            }
+        } }.join();
+
+        REQUIRE(allocator.drain_remote_frees() == BLOCKS_COUNT);
+        REQUIRE(count_owned_leaves(allocator) == leaves_count);
+        REQUIRE(allocator.allocate(OWNED_SIZE / 2) != nullptr);
+    }
+
+    SECTION("ownership can be handed to another thread")
+    {
+        const auto block = allocator.allocate(100);
+        auto owned = false;
+
+        std::thread{ [&allocator, &owned, block]()
+        {
+            allocator.take_ownership();
+            allocator.deallocate(block);
+            owned = allocator.is_owned_by_current_thread() &&
+                    !allocator.has_remote_frees();
+        } }.join();
+
+        REQUIRE(owned);
+        allocator.take_ownership();
+        REQUIRE(count_owned_leaves(allocator) == leaves_count);
+    }
+
+    SECTION("consumers free what the owner produces")
+    {
+        constexpr auto CONSUMERS = 4u;
+        constexpr auto MESSAGES = 20000u;
+        constexpr auto MESSAGE_SIZE = 200u;
+        auto queue = std::vector<unsigned char*>{};
+        std::mutex queue_lock;
+        std::atomic<bool> done{ false };
+        auto consumers = std::vector<std::thread>{};
+        bool messages_are_intact[CONSUMERS] = {};
+
+        for (auto i = 0u; i < CONSUMERS; ++i)
+        {
+            consumers.emplace_back(
+                [&allocator, &queue, &queue_lock, &done,
+                 &messages_are_intact, i]()
+                {
+                    auto intact = true;
+                    auto finished = false;
+                    auto messages = std::vector<unsigned char*>{};
+
+                    // The queue is taken once more after the producer is
+                    // done, so no message is left behind.
+                    while (!finished)
+                    {
+                        finished = done.load();
+                        {
+                            std::lock_guard<std::mutex> guard{ queue_lock };
+                            messages.swap(queue);
+                        }
+
+                        for (const auto message : messages)
+                        {
+                            intact = intact && message[0] == message[1];
+                            allocator.deallocate(message, MESSAGE_SIZE);
+                        }
+
+                        messages.clear();
+                    }
+
+                    messages_are_intact[i] = intact;
+                }
+            );
+        }
+
+        for (auto i = 0u; i < MESSAGES; ++i)
+        {
+            auto message = static_cast<unsigned char*>(
+                allocator.allocate(MESSAGE_SIZE)
+            );
+
+            while (message == nullptr)
+            {
+                std::this_thread::yield();
+                message = static_cast<unsigned char*>(
+                    allocator.allocate(MESSAGE_SIZE)
+                );
+            }
+
+            std::memset(message, int(i % 251), MESSAGE_SIZE);
+            std::lock_guard<std::mutex> guard{ queue_lock };
+            queue.push_back(message);
+        }
+
+        done.store(true);
+
+        for (auto& consumer : consumers)
+        {
+            consumer.join();
+        }
+
+        for (const auto intact : messages_are_intact)
+        {
+            CHECK(intact);
+        }
+
+        allocator.drain_remote_frees();
+        REQUIRE(count_owned_leaves(allocator) == leaves_count);
+    }
+}
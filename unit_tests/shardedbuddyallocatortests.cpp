@@ -0,0 +1,215 @@
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "catch.hpp"
+
+#include "shardedbuddyallocator.hpp"
+
+namespace alc = allocator;
+
+
+namespace
+{
+    constexpr auto SHARDED_SIZE = 1u << 20;
+    constexpr auto SHARDS_COUNT = 4u;
+    alignas(std::max_align_t) char sharded_memory[SHARDED_SIZE];
+
+
+    std::vector<void*> allocate_all(alc::ShardedBuddyAllocator& allocator,
+                                    std::size_t size)
+    {
+        auto blocks = std::vector<void*>{};
+
+        while (const auto block = allocator.allocate(size))
+        {
+            blocks.push_back(block);
+        }
+
+        return blocks;
+    }
+}
+
+
+TEST_CASE("ShardedBuddyAllocator special members",
+          "[sharded buddy allocator][special members]")
+{
+    SECTION("default ctor creates an object that manages no memory")
+    {
+        auto allocator = alc::ShardedBuddyAllocator{};
+
+        REQUIRE_FALSE(allocator.manages_memory());
+        REQUIRE(allocator.get_shards_count() == 0);
+        REQUIRE(allocator.allocate(1) == nullptr);
+    }
+
+    SECTION("ctor throws for no memory or no shards")
+    {
+        REQUIRE_THROWS_AS(
+            alc::ShardedBuddyAllocator(nullptr, SHARDED_SIZE, SHARDS_COUNT),
+            std::invalid_argument
+        );
+        REQUIRE_THROWS_AS(
+            alc::ShardedBuddyAllocator(sharded_memory, SHARDED_SIZE, 0),
+            std::invalid_argument
+        );
+    }
+
+    SECTION("the memory is split evenly between the shards")
+    {
+        const auto allocator = alc::ShardedBuddyAllocator(sharded_memory,
+                                                          SHARDED_SIZE + 1,
+                                                          SHARDS_COUNT);
+
+        REQUIRE(allocator.manages_memory());
+        REQUIRE(allocator.get_shards_count() == SHARDS_COUNT);
+        REQUIRE(allocator.get_shard_size() == SHARDED_SIZE / SHARDS_COUNT);
+    }
+
+    SECTION("move ctor leaves source with no memory to manage")
+    {
+        auto source = alc::ShardedBuddyAllocator(sharded_memory,
+                                                 SHARDED_SIZE,
+                                                 SHARDS_COUNT);
+        const auto block = source.allocate(100);
+
+        auto allocator = std::move(source);
+
+        REQUIRE_FALSE(source.manages_memory());
+        REQUIRE(allocator.manages_memory());
+        REQUIRE(allocator.owns(block));
+        allocator.deallocate(block);
+    }
+}
+
+
+TEST_CASE("ShardedBuddyAllocator allocation and deallocation",
+          "[sharded buddy allocator][allocation]")
+{
+    auto allocator = alc::ShardedBuddyAllocator(sharded_memory,
+                                                SHARDED_SIZE,
+                                                SHARDS_COUNT);
+    const auto shard_size = allocator.get_shard_size();
+
+    SECTION("blocks come from the calling thread's shard first")
+    {
+        const auto block = allocator.allocate(1000);
+
+        REQUIRE(block != nullptr);
+        REQUIRE(allocator.shard_of(block) == allocator.home_shard());
+        allocator.deallocate(block, 1000);
+    }
+
+    SECTION("blocks are stolen from other shards once a shard runs dry")
+    {
+        auto blocks = allocate_all(allocator, 1024);
+        auto blocks_per_shard = std::vector<std::size_t>(SHARDS_COUNT);
+
+        for (const auto block : blocks)
+        {
+            ++blocks_per_shard[allocator.shard_of(block)];
+        }
+
+        REQUIRE(allocator.shard_of(blocks.front()) == allocator.home_shard());
+
+        for (const auto count : blocks_per_shard)
+        {
+            REQUIRE(count > shard_size / 1024 / 2);
+        }
+
+        for (const auto block : blocks)
+        {
+            allocator.deallocate(block, 1024);
+        }
+
+        // Every block went back to the shard it came from.
+        blocks = allocate_all(allocator, shard_size / 4);
+
+        REQUIRE(blocks.size() >= SHARDS_COUNT);
+
+        for (const auto block : blocks)
+        {
+            allocator.deallocate(block);
+        }
+    }
+
+    SECTION("blocks are freed to their shard from any thread")
+    {
+        constexpr auto THREADS = 8u;
+        constexpr auto BLOCKS_PER_THREAD = 100u;
+        constexpr auto BLOCK_SIZE = 256u;
+        auto blocks = std::vector<std::vector<void*>>(THREADS);
+        auto threads = std::vector<std::thread>{};
+
+        for (auto i = 0u; i < THREADS; ++i)
+        {
+            threads.emplace_back([&allocator, &blocks, i]()
+            {
+                for (auto j = 0u; j < BLOCKS_PER_THREAD; ++j)
+                {
+                    const auto block = allocator.allocate(BLOCK_SIZE);
+
+                    if (block != nullptr)
+                    {
+                        std::memset(block, int(i + 1), BLOCK_SIZE);
+                        blocks[i].push_back(block);
+                    }
+                }
+            });
+        }
+
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+
+        threads.clear();
+        bool blocks_are_intact[THREADS] = {};
+
+        for (auto i = 0u; i < THREADS; ++i)
+        {
+            // Each thread frees the blocks another thread allocated.
+            threads.emplace_back([&allocator, &blocks, &blocks_are_intact, i]()
+            {
+                const auto owner = (i + 1) % THREADS;
+                auto intact = blocks[owner].size() == BLOCKS_PER_THREAD;
+
+                for (const auto block : blocks[owner])
+                {
+                    const auto bytes = static_cast<unsigned char*>(block);
+
+                    for (auto k = 0u; k < BLOCK_SIZE; ++k)
+                    {
+                        intact = intact && bytes[k] == owner + 1;
+                    }
+
+                    allocator.deallocate(block, BLOCK_SIZE);
+                }
+
+                blocks_are_intact[i] = intact;
+            });
+        }
+
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+
+        for (const auto intact : blocks_are_intact)
+        {
+            CHECK(intact);
+        }
+
+        REQUIRE(allocate_all(allocator, shard_size / 4).size() >=
+                SHARDS_COUNT);
+    }
+
+    SECTION("memory outside the shards is not owned")
+    {
+        auto variable = 0;
+
+        REQUIRE_FALSE(allocator.owns(&variable));
+        REQUIRE(allocator.owns(sharded_memory + SHARDED_SIZE - 1));
+    }
+}
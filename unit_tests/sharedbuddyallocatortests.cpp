@@ -0,0 +1,323 @@
+#include "sharedbuddyallocator.hpp"
+
+#if defined(__SHARED_BUDDY_ALLOCATOR_AVAILABLE__)
+
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <set>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+#include "catch.hpp"
+
+namespace alc = allocator;
+
+
+namespace
+{
+    const std::size_t SEGMENT_SIZE = 1 << 20;
+
+
+    class SharedFile
+    {
+    public:
+        explicit SharedFile(std::size_t size) :
+            file(std::tmpfile()),
+            size(size)
+        {
+            REQUIRE(file != nullptr);
+            REQUIRE(ftruncate(fileno(file), size) == 0);
+        }
+
+        SharedFile(const SharedFile&) = delete;
+        SharedFile& operator=(const SharedFile&) = delete;
+
+        ~SharedFile()
+        {
+            std::fclose(file);
+        }
+
+        void* map() const
+        {
+            const auto result = mmap(nullptr,
+                                     size,
+                                     PROT_READ | PROT_WRITE,
+                                     MAP_SHARED,
+                                     fileno(file),
+                                     0);
+            REQUIRE(result != MAP_FAILED);
+
+            return result;
+        }
+
+        void unmap(void* mapping) const
+        {
+            munmap(mapping, size);
+        }
+
+    private:
+        std::FILE* file;
+        std::size_t size;
+    };
+}
+
+
+TEST_CASE("SharedBuddyAllocator special members",
+          "[shared buddy allocator][special members]")
+{
+    SECTION("default ctor creates an allocator with no memory")
+    {
+        auto allocator = alc::SharedBuddyAllocator{};
+
+        REQUIRE_FALSE(allocator.manages_memory());
+        REQUIRE(allocator.allocate(1) == nullptr);
+    }
+
+    SECTION("ctor throws for a segment too small for an arena")
+    {
+        alignas(std::max_align_t) unsigned char segment[256];
+
+        REQUIRE_THROWS_AS(alc::SharedBuddyAllocator(segment, sizeof(segment)),
+                          std::invalid_argument);
+    }
+
+    SECTION("attaching throws for a segment with no allocator")
+    {
+        alignas(std::max_align_t) unsigned char segment[256] = {};
+
+        REQUIRE_THROWS_AS(alc::SharedBuddyAllocator(segment),
+                          std::invalid_argument);
+    }
+
+    SECTION("move ctor empties source")
+    {
+        const SharedFile file(SEGMENT_SIZE);
+        const auto segment = file.map();
+        auto source = alc::SharedBuddyAllocator(segment, SEGMENT_SIZE);
+
+        auto allocator = std::move(source);
+
+        REQUIRE_FALSE(source.manages_memory());
+        REQUIRE(allocator.manages_memory());
+        REQUIRE(allocator.allocate(1) != nullptr);
+        file.unmap(segment);
+    }
+}
+
+
+TEST_CASE("SharedBuddyAllocator mapped at different addresses",
+          "[shared buddy allocator][allocation]")
+{
+    const SharedFile file(SEGMENT_SIZE);
+    const auto first_segment = file.map();
+    const auto second_segment = file.map();
+    REQUIRE(first_segment != second_segment);
+
+    auto first = alc::SharedBuddyAllocator(first_segment,
+                                           SEGMENT_SIZE,
+                                           alc::LevelLookup::split_map,
+                                           alc::MemoryContents::zero_filled);
+    auto second = alc::SharedBuddyAllocator(second_segment);
+
+    SECTION("blocks are exchanged through offsets")
+    {
+        const auto block = first.allocate(100);
+        REQUIRE(block != nullptr);
+        std::strcpy(static_cast<char*>(block), "shared");
+
+        const auto offset = first.offset_of(block);
+        const auto same_block = second.block_at(offset);
+
+        REQUIRE(same_block != block);
+        REQUIRE(std::strcmp(static_cast<char*>(same_block), "shared") == 0);
+        REQUIRE(second.offset_of(same_block) == offset);
+    }
+
+    SECTION("both views see the same free memory")
+    {
+        auto offsets = std::set<std::size_t>{};
+
+        while (const auto block = first.allocate(1024))
+        {
+            REQUIRE(offsets.insert(first.offset_of(block)).second);
+        }
+
+        REQUIRE_FALSE(offsets.empty());
+        REQUIRE(second.allocate(1024) == nullptr);
+
+        for (const auto offset : offsets)
+        {
+            second.deallocate(second.block_at(offset), 1024);
+        }
+
+        const auto block = first.allocate(SEGMENT_SIZE / 4);
+
+        REQUIRE(block != nullptr);
+        first.deallocate(block);
+    }
+
+    SECTION("the level map is shared as well")
+    {
+        const SharedFile other_file(SEGMENT_SIZE);
+        const auto creator_segment = other_file.map();
+        const auto user_segment = other_file.map();
+        auto creator = alc::SharedBuddyAllocator(creator_segment,
+                                                 SEGMENT_SIZE,
+                                                 alc::LevelLookup::level_map);
+        auto user = alc::SharedBuddyAllocator(user_segment);
+
+        const auto block = creator.allocate(4096);
+        REQUIRE(block != nullptr);
+        user.deallocate(user.block_at(creator.offset_of(block)));
+
+        const auto whole = creator.allocate(SEGMENT_SIZE / 4);
+
+        REQUIRE(whole != nullptr);
+        other_file.unmap(creator_segment);
+        other_file.unmap(user_segment);
+    }
+
+    file.unmap(first_segment);
+    file.unmap(second_segment);
+}
+
+
+TEST_CASE("SharedBuddyAllocator across processes",
+          "[shared buddy allocator][processes]")
+{
+    const auto BLOCKS_PER_PROCESS = std::size_t(200);
+    const auto BLOCK_SIZE = std::size_t(256);
+    const auto segment = mmap(nullptr,
+                              SEGMENT_SIZE,
+                              PROT_READ | PROT_WRITE,
+                              MAP_SHARED | MAP_ANONYMOUS,
+                              -1,
+                              0);
+    REQUIRE(segment != MAP_FAILED);
+    auto allocator = alc::SharedBuddyAllocator(segment, SEGMENT_SIZE);
+    const auto child_offsets = static_cast<std::size_t*>(
+        allocator.allocate(BLOCKS_PER_PROCESS * sizeof(std::size_t))
+    );
+    REQUIRE(child_offsets != nullptr);
+
+    const auto child = fork();
+    REQUIRE(child != -1);
+    const auto owner = static_cast<unsigned char>(child == 0 ? 1 : 2);
+    auto own_blocks = std::vector<void*>{};
+
+    // Both processes allocate at the same time, the process-shared lock
+    // keeps them from handing out the same block twice.
+    for (auto i = std::size_t(0); i < BLOCKS_PER_PROCESS; ++i)
+    {
+        const auto block = allocator.allocate(BLOCK_SIZE);
+
+        if (block == nullptr)
+        {
+            break;
+        }
+
+        std::memset(block, owner, BLOCK_SIZE);
+        own_blocks.push_back(block);
+    }
+
+    if (child == 0)
+    {
+        for (auto i = std::size_t(0); i < own_blocks.size(); ++i)
+        {
+            child_offsets[i] = allocator.offset_of(own_blocks[i]);
+        }
+
+        _exit(own_blocks.size() == BLOCKS_PER_PROCESS ? 0 : 1);
+    }
+
+    auto status = 0;
+    REQUIRE(waitpid(child, &status, 0) == child);
+    REQUIRE(WIFEXITED(status));
+    REQUIRE(WEXITSTATUS(status) == 0);
+    REQUIRE(own_blocks.size() == BLOCKS_PER_PROCESS);
+
+    auto intact = true;
+
+    for (auto i = std::size_t(0); i < BLOCKS_PER_PROCESS; ++i)
+    {
+        const auto parent_block =
+            static_cast<unsigned char*>(own_blocks[i]);
+        const auto child_block = static_cast<unsigned char*>(
+            allocator.block_at(child_offsets[i])
+        );
+
+        for (auto j = std::size_t(0); j < BLOCK_SIZE; ++j)
+        {
+            intact = intact && parent_block[j] == 2 && child_block[j] == 1;
+        }
+
+        allocator.deallocate(child_block, BLOCK_SIZE);
+        allocator.deallocate(parent_block, BLOCK_SIZE);
+    }
+
+    REQUIRE(intact);
+    allocator.deallocate(child_offsets);
+    REQUIRE(allocator.allocate(SEGMENT_SIZE / 4) != nullptr);
+    munmap(segment, SEGMENT_SIZE);
+}
+
+
+#if !defined(__APPLE__)
+TEST_CASE("SharedBuddyAllocator when a process dies holding the lock",
+          "[shared buddy allocator][processes]")
+{
+    const auto segment = mmap(nullptr,
+                              SEGMENT_SIZE,
+                              PROT_READ | PROT_WRITE,
+                              MAP_SHARED | MAP_ANONYMOUS,
+                              -1,
+                              0);
+    REQUIRE(segment != MAP_FAILED);
+    auto died_holding_the_lock = false;
+
+    // A child which allocates and frees in a loop spends most of its
+    // time holding the lock, so it is killed while holding it within a
+    // few attempts.
+    for (auto attempt = 0; attempt < 100 && !died_holding_the_lock; ++attempt)
+    {
+        auto allocator = alc::SharedBuddyAllocator(segment, SEGMENT_SIZE);
+        const auto child = fork();
+        REQUIRE(child != -1);
+
+        if (child == 0)
+        {
+            while (true)
+            {
+                allocator.deallocate(allocator.allocate(1000), 1000);
+            }
+        }
+
+        usleep(1000);
+        REQUIRE(kill(child, SIGKILL) == 0);
+        REQUIRE(waitpid(child, nullptr, 0) == child);
+
+        try
+        {
+            allocator.deallocate(allocator.allocate(1000), 1000);
+        }
+        catch (const std::runtime_error&)
+        {
+            died_holding_the_lock = true;
+
+            // The segment stays unusable rather than deadlocking.
+            REQUIRE_THROWS_AS(allocator.allocate(1), std::runtime_error);
+            REQUIRE_THROWS_AS(alc::SharedBuddyAllocator(segment).allocate(1),
+                              std::runtime_error);
+        }
+    }
+
+    REQUIRE(died_holding_the_lock);
+    munmap(segment, SEGMENT_SIZE);
+}
+#endif
+
+#endif
@@ -0,0 +1,262 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <set>
+#include <vector>
+
+#include "catch.hpp"
+
+#include "slaballocator.hpp"
+
+namespace alc = allocator;
+
+
+namespace
+{
+    constexpr auto SLAB_ARENA_SIZE = 1u << 20;
+    alignas(std::max_align_t) char slab_arena[SLAB_ARENA_SIZE];
+    alignas(4096) char page_aligned_arena[SLAB_ARENA_SIZE];
+
+
+    bool is_aligned_to(void* block, std::size_t alignment)
+    {
+        return reinterpret_cast<std::uintptr_t>(block) % alignment == 0;
+    }
+}
+
+
+TEST_CASE("SlabAllocator special members",
+          "[slab allocator][special members]")
+{
+    auto buddy = alc::BuddyAllocator(slab_arena, SLAB_ARENA_SIZE);
+
+    SECTION("default ctor creates a detached allocator")
+    {
+        auto allocator = alc::SlabAllocator{};
+
+        REQUIRE_FALSE(allocator.is_attached());
+        REQUIRE(allocator.allocate(8) == nullptr);
+        REQUIRE(allocator.get_slabs_count() == 0);
+    }
+
+    SECTION("move ctor leaves source detached")
+    {
+        auto source = alc::SlabAllocator(buddy);
+        const auto object = source.allocate(24);
+
+        auto allocator = std::move(source);
+
+        REQUIRE_FALSE(source.is_attached());
+        REQUIRE(source.get_slabs_count() == 0);
+        REQUIRE(allocator.is_attached());
+        REQUIRE(allocator.get_slabs_count() == 1);
+        allocator.deallocate(object, 24);
+    }
+
+    SECTION("dtor returns all slabs to the buddy allocator")
+    {
+        const auto free_block = buddy.allocate(SLAB_ARENA_SIZE / 2);
+        REQUIRE(free_block != nullptr);
+        buddy.deallocate(free_block);
+
+        {
+            auto allocator = alc::SlabAllocator(buddy);
+
+            for (auto size = std::size_t(1); size <= 128; ++size)
+            {
+                REQUIRE(allocator.allocate(size) != nullptr);
+            }
+        }
+
+        REQUIRE(buddy.allocate(SLAB_ARENA_SIZE / 2) == free_block);
+    }
+}
+
+
+TEST_CASE("SlabAllocator allocation and deallocation",
+          "[slab allocator][allocation]")
+{
+    auto buddy = alc::BuddyAllocator(slab_arena, SLAB_ARENA_SIZE);
+    auto allocator = alc::SlabAllocator(buddy);
+
+    SECTION("small objects are packed into a single slab")
+    {
+        constexpr auto OBJECT_SIZE = std::size_t(24);
+        auto objects = std::vector<char*>{};
+
+        for (auto i = 0; i < 100; ++i)
+        {
+            objects.push_back(
+                static_cast<char*>(allocator.allocate(OBJECT_SIZE))
+            );
+        }
+
+        REQUIRE(allocator.get_slabs_count() == 1);
+        std::sort(objects.begin(), objects.end());
+
+        for (auto i = std::size_t(1); i < objects.size(); ++i)
+        {
+            REQUIRE(objects[i] - objects[i - 1] == OBJECT_SIZE);
+        }
+
+        for (const auto object : objects)
+        {
+            allocator.deallocate(object, OBJECT_SIZE);
+        }
+    }
+
+    SECTION("objects are aligned to their size class")
+    {
+        for (auto size = std::size_t(1); size <= 128; ++size)
+        {
+            const auto object = allocator.allocate(size);
+            const auto class_size = (size + 7) / 8 * 8;
+
+            REQUIRE(object != nullptr);
+            REQUIRE(is_aligned_to(object, 8));
+            REQUIRE((class_size % 16 != 0 || is_aligned_to(object, 16)));
+        }
+    }
+
+    SECTION("bigger blocks come from the buddy allocator")
+    {
+        const auto block = allocator.allocate(129);
+
+        REQUIRE(block != nullptr);
+        REQUIRE(allocator.get_slabs_count() == 0);
+        allocator.deallocate(block, 129);
+    }
+
+    SECTION("size classes use separate slabs")
+    {
+        const auto small = allocator.allocate(8);
+        const auto big = allocator.allocate(128);
+
+        REQUIRE(allocator.get_slabs_count() == 2);
+        allocator.deallocate(small, 8);
+        allocator.deallocate(big, 128);
+    }
+
+    SECTION("a slab is filled before another one is created")
+    {
+        constexpr auto OBJECT_SIZE = std::size_t(128);
+        constexpr auto PER_SLAB =
+            (alc::SlabAllocator::SLAB_SIZE - 128) / OBJECT_SIZE;
+        auto objects = std::vector<void*>{};
+
+        for (auto i = std::size_t(0); i < PER_SLAB; ++i)
+        {
+            objects.push_back(allocator.allocate(OBJECT_SIZE));
+        }
+
+        REQUIRE(allocator.get_slabs_count() == 1);
+        objects.push_back(allocator.allocate(OBJECT_SIZE));
+        REQUIRE(allocator.get_slabs_count() == 2);
+
+        // Freeing an object of the full slab makes room in it again.
+        allocator.deallocate(objects.front(), OBJECT_SIZE);
+        REQUIRE(allocator.allocate(OBJECT_SIZE) == objects.front());
+    }
+
+    SECTION("empty slabs go back to the buddy allocator")
+    {
+        constexpr auto OBJECT_SIZE = std::size_t(64);
+        auto objects = std::vector<void*>{};
+
+        while (allocator.get_slabs_count() < 4)
+        {
+            objects.push_back(allocator.allocate(OBJECT_SIZE));
+        }
+
+        for (const auto object : objects)
+        {
+            allocator.deallocate(object, OBJECT_SIZE);
+        }
+
+        // One empty slab is kept for the size class.
+        REQUIRE(allocator.get_slabs_count() == 1);
+        REQUIRE(allocator.release_empty_slabs() == 1);
+        REQUIRE(allocator.get_slabs_count() == 0);
+    }
+
+    SECTION("random allocations keep objects intact")
+    {
+        auto engine = std::mt19937{ 7 };
+        auto sizes = std::uniform_int_distribution<std::size_t>{ 1, 200 };
+        struct Object { unsigned char* address; std::size_t size; };
+        auto objects = std::vector<Object>{};
+        auto intact = true;
+
+        for (auto i = 0; i < 20000; ++i)
+        {
+            if (objects.size() < 500 && engine() % 3 != 0)
+            {
+                const auto size = sizes(engine);
+                const auto address =
+                    static_cast<unsigned char*>(allocator.allocate(size));
+                REQUIRE(address != nullptr);
+                std::memset(address, int(size), size);
+                objects.push_back({ address, size });
+            }
+            else if (!objects.empty())
+            {
+                const auto j = engine() % objects.size();
+                const auto object = objects[j];
+
+                for (auto k = std::size_t(0); k < object.size; ++k)
+                {
+                    intact = intact && object.address[k] == object.size % 256;
+                }
+
+                allocator.deallocate(object.address, object.size);
+                objects[j] = objects.back();
+                objects.pop_back();
+            }
+        }
+
+        REQUIRE(intact);
+
+        for (const auto object : objects)
+        {
+            allocator.deallocate(object.address, object.size);
+        }
+
+        allocator.release_empty_slabs();
+        REQUIRE(allocator.get_slabs_count() == 0);
+    }
+}
+
+
+TEST_CASE("SlabAllocator over memory not aligned to a slab",
+          "[slab allocator][alignment]")
+{
+    // Shifted off a page boundary, the arena is aligned to a slab only
+    // relative to the buddy allocator's logical start.
+    const auto shift = alignof(std::max_align_t);
+    auto buddy = alc::BuddyAllocator(page_aligned_arena + shift,
+                                     SLAB_ARENA_SIZE - shift);
+    auto allocator = alc::SlabAllocator(buddy);
+    constexpr auto OBJECT_SIZE = std::size_t(64);
+    constexpr auto PER_SLAB =
+        (alc::SlabAllocator::SLAB_SIZE - 128) / OBJECT_SIZE;
+    auto objects = std::vector<void*>{};
+
+    while (const auto object = allocator.allocate(OBJECT_SIZE))
+    {
+        objects.push_back(object);
+    }
+
+    // Slabs of 8 KiB blocks would fill less than half of the arena.
+    REQUIRE(objects.size() == allocator.get_slabs_count() * PER_SLAB);
+    REQUIRE(objects.size() * OBJECT_SIZE > SLAB_ARENA_SIZE / 4 * 3);
+
+    for (const auto object : objects)
+    {
+        allocator.deallocate(object, OBJECT_SIZE);
+    }
+
+    REQUIRE(allocator.get_slabs_count() == 1);
+    REQUIRE(allocator.release_empty_slabs() == 1);
+    REQUIRE(buddy.allocate(SLAB_ARENA_SIZE / 4) != nullptr);
+}